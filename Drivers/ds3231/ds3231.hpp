@@ -1,100 +1,225 @@
 #pragma once
 
 #include <cstdint>
+#include <atomic>
 #include "../../Periph/i2c_ch32v00x.hpp"
 
-using DateStruct = struct {
+struct DateStruct {
     uint8_t date;
     uint8_t month;
     uint8_t year;
 };
-using TimeStruct = struct {
+struct TimeStruct {
     uint8_t hours;
     uint8_t minutes;
     uint8_t seconds;
 };
+struct DS3231Snapshot {
+    TimeStruct time;
+    DateStruct date;
+    int8_t temperature;
+};
 
+template<typename I2cBus>
 class DS3231 {
 private:
     void setControlRegister() {
-        _i2c.memoryWrite(_devAddress, 0x0E, I2cMemAddrSize::oneByte, &_raw[0x0E], 1, 10);
+        I2cBus::memoryWrite(_devAddress, 0x0E, I2cMemAddrSize::oneByte, &_raw[0x0E], 1, TIMEOUT_MS);
     }
-    //osMutexId _rtcMutex;
-    void initMutex() {
-        //_rtcMutex = osMutexNew(nullptr);
-        //if (_rtcMutex == nullptr) {
-        //    while (1);
-        //}
+    // Seqlock writer: the sequence is odd while the snapshot changes. The background reads publish from
+    // the I2C interrupt, so the main loop must not write at the same time (no background read running).
+    void publish() {
+        _sequence = _sequence + 1;
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        _snapshot.time = decodeTime();
+        _snapshot.date = decodeDate();
+        _snapshot.temperature = _data.temperature;
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        _sequence = _sequence + 1;
     }
-    void lock() {
-        //osMutexWait(_rtcMutex, osWaitForever);
+    TimeStruct decodeTime() {
+        return {static_cast<uint8_t>(_data.hourTens*10 + _data.hours), 
+                static_cast<uint8_t>(_data.minuteTens*10 + _data.minutes),
+                static_cast<uint8_t>(_data.secondTens*10 + _data.seconds)};
     }
-    void unlock() {
-        //osMutexRelease(_rtcMutex);
+    DateStruct decodeDate() {
+        return {static_cast<uint8_t>(_data.dateTens*10 + _data.date), 
+                static_cast<uint8_t>(_data.monthTens*10 + _data.month),
+                static_cast<uint8_t>(_data.yearTens*10 + _data.year)};
     }
 public:
     static constexpr uint16_t DATA_SIZE = 19;
+    // the chip converts the temperature every 64 s, reading it more often gives the same value
+    static constexpr uint8_t TEMPERATURE_PERIOD = 64;
+    // the blocking calls may wait behind a whole display frame in the I2C queue, about 25 ms at 400 kHz
+    static constexpr uint32_t TIMEOUT_MS = 50;
 
-    DS3231(I2CInterface i2c, uint8_t devAddress) 
-    : _i2c(i2c), _devAddress(devAddress) {}
+    constexpr DS3231(uint8_t devAddress)
+    : _devAddress(devAddress) {}
 
     void init() {
-        initMutex();
         readData();
         _raw[0x0E] = 0x04;
         setControlRegister();
     }
+    // INTCN cleared and RS2:RS1 = 0 give a 1 Hz square wave on INT/SQW (open drain), its falling edge
+    // comes with the seconds update. init() sets the pin back to the alarm interrupt output.
+    void enableSquareWave1Hz() {
+        _raw[0x0E] = 0x00;
+        setControlRegister();
+    }
     bool isTimeWrong() {
         return _data.OSF;
     }
+    // Consistent copy of the decoded registers, retried when a background read published in between
+    DS3231Snapshot getSnapshot() {
+        for(;;) {
+            uint32_t sequence = _sequence;
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+            DS3231Snapshot snapshot = _snapshot;
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+            if((sequence & 1) == 0 && sequence == _sequence) {
+                return snapshot;
+            }
+        }
+    }
     DateStruct getDate() {
-        return {static_cast<uint8_t>(_data.dateTens*10 + _data.date), 
-                static_cast<uint8_t>(_data.monthTens*10 + _data.month),
-                static_cast<uint8_t>(_data.yearTens*10 + _data.year)};
+        return getSnapshot().date;
     }
     TimeStruct getTime() {
-        return {static_cast<uint8_t>(_data.hourTens*10 + _data.hours), 
-                static_cast<uint8_t>(_data.minuteTens*10 + _data.minutes),
-                static_cast<uint8_t>(_data.secondTens*10 + _data.seconds)};
+        return getSnapshot().time;
     }
     int8_t getTemperature() {
-        return _data.temperature;
+        return getSnapshot().temperature;
     }
+    // setDate()/setTime() only change the register image, flush() writes the registers they changed
     void setDate(DateStruct dateStruct) {
-        lock();
+        uint8_t previous[3] = {_raw[DATE], _raw[MONTH], _raw[YEAR]};
         _data.dateTens = dateStruct.date / 10;
         _data.date = dateStruct.date % 10;
         _data.monthTens = dateStruct.month / 10;
         _data.month = dateStruct.month % 10;
         _data.yearTens = dateStruct.year / 10;
         _data.year = dateStruct.year % 10;
-        _data.OSF = 0;
-        unlock();
+        markChanged(DATE, previous, 3);
+        clearOscillatorStop();
+        publish();
     }
     void setTime(TimeStruct timeStruct) {
-        lock();
+        uint8_t previous[3] = {_raw[SECONDS], _raw[MINUTES], _raw[HOURS]};
         _data.hourTens = timeStruct.hours / 10;
         _data.hours = timeStruct.hours % 10;
         _data.minuteTens = timeStruct.minutes / 10;
         _data.minutes = timeStruct.minutes % 10;
         _data.secondTens = timeStruct.seconds / 10;
         _data.seconds = timeStruct.seconds % 10;
-        _data.OSF = 0;
-        unlock();
+        markChanged(SECONDS, previous, 3);
+        clearOscillatorStop();
+        publish();
     }
     void readData() {
-        lock();
-        _i2c.memoryRead(_devAddress, 0x00, I2cMemAddrSize::oneByte, _raw, DATA_SIZE, 10);
-        unlock();
+        I2cBus::memoryRead(_devAddress, 0x00, I2cMemAddrSize::oneByte, _raw, DATA_SIZE, TIMEOUT_MS);
+        _bytesRead += DATA_SIZE;
+        publish();
+    }
+    // Reads only the seconds register, the register image and the snapshot are left as they are
+    uint8_t readSeconds() {
+        uint8_t value = 0;
+        I2cBus::memoryRead(_devAddress, SECONDS, I2cMemAddrSize::oneByte, &value, 1, TIMEOUT_MS);
+        _bytesRead += 1;
+        return (value >> 4) * 10 + (value & 0x0F);
+    }
+    // Queues a read of all registers, the values are updated in the background
+    void readDataAsync() {
+        submitRead(0x00, DATA_SIZE);
+    }
+    // Queues a read of the two temperature registers only
+    void readTemperatureAsync() {
+        submitRead(TEMPERATURE, 2);
+    }
+    // register bytes requested from the chip since start up, the difference over a minute is the
+    // bus load of the polling
+    uint32_t getBytesRead() const {
+        return _bytesRead;
     }
     void writeData() {
-        lock();
-        _i2c.memoryWrite(_devAddress, 0x00, I2cMemAddrSize::oneByte, _raw, DATA_SIZE, 10);
-        unlock();
+        I2cBus::memoryWrite(_devAddress, 0x00, I2cMemAddrSize::oneByte, _raw, DATA_SIZE, TIMEOUT_MS);
+        _dirty = 0;
+        _clearOscillatorStop = false;
+    }
+    // Writes only the changed registers, one transaction per run of consecutive registers.
+    // The seconds come first, writing them restarts the chip's second.
+    void flush() {
+        uint8_t reg = 0;
+        while(_dirty != 0 && reg < DATA_SIZE) {
+            if((_dirty & (1UL << reg)) == 0) {
+                reg++;
+                continue;
+            }
+            uint8_t first = reg;
+            while(reg < DATA_SIZE && (_dirty & (1UL << reg)) != 0) {
+                _dirty &= ~(1UL << reg);
+                reg++;
+            }
+            I2cBus::memoryWrite(_devAddress, first, I2cMemAddrSize::oneByte, &_raw[first], reg - first, TIMEOUT_MS);
+        }
+        if(_clearOscillatorStop) {
+            // the alarm flags may have been set since the registers were read, write back what the chip has now
+            I2cBus::memoryRead(_devAddress, STATUS, I2cMemAddrSize::oneByte, &_raw[STATUS], 1, TIMEOUT_MS);
+            _bytesRead += 1;
+            _data.OSF = 0;
+            I2cBus::memoryWrite(_devAddress, STATUS, I2cMemAddrSize::oneByte, &_raw[STATUS], 1, TIMEOUT_MS);
+            _clearOscillatorStop = false;
+        }
+    }
+    bool isDirty() {
+        return _dirty != 0 || _clearOscillatorStop;
     }
 private:
-    I2CInterface _i2c;
+    enum Register : uint8_t {
+        SECONDS = 0x00,
+        MINUTES = 0x01,
+        HOURS = 0x02,
+        DAY = 0x03,
+        DATE = 0x04,
+        MONTH = 0x05,
+        YEAR = 0x06,
+        STATUS = 0x0F,
+        TEMPERATURE = 0x11
+    };
+
     uint8_t _devAddress;
+    volatile uint32_t _sequence = 0;
+    // one bit per register changed since the last write
+    uint32_t _dirty = 0;
+    bool _clearOscillatorStop = false;
+    uint32_t _bytesRead = 0;
+    DS3231Snapshot _snapshot = {};
+
+    void markChanged(uint8_t first, const uint8_t* previous, uint8_t count) {
+        for(uint8_t i = 0; i < count; i++) {
+            if(_raw[first + i] != previous[i]) {
+                _dirty |= 1UL << (first + i);
+            }
+        }
+    }
+    // a set time is valid again, flush() clears the flag in the chip
+    void clearOscillatorStop() {
+        if(_data.OSF) {
+            _data.OSF = 0;
+            _clearOscillatorStop = true;
+        }
+    }
+    void submitRead(uint8_t first, uint8_t count) {
+        if(I2cBus::submit(I2cTransaction::read(_devAddress, first, I2cMemAddrSize::oneByte, &_raw[first], count, readDone, this))) {
+            _bytesRead += count;
+        }
+    }
+    static void readDone(void* context, uint32_t error) {
+        if(error == 0) {
+            static_cast<DS3231*>(context)->publish();
+        }
+    }
     union {
         struct {
             unsigned seconds :4;
@@ -136,6 +261,6 @@ private:
             unsigned reserved2 :6;
             unsigned temperatureLSB :2;
         }_data;
-        uint8_t _raw[DS3231::DATA_SIZE];
+        uint8_t _raw[DATA_SIZE] = {};
     };
 };
\ No newline at end of file
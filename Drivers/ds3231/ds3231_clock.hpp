@@ -0,0 +1,175 @@
+#pragma once
+
+#include <cstdint>
+#include "ds3231.hpp"
+
+// Local copy of the DS3231 time advanced by the SysTick milliseconds and, when it is wired, the 1 Hz square wave.
+// The chip is read only every RESYNC_MINUTES and on resync(), getTime()/getDate() need no bus access.
+// The temperature is read in the background as often as the chip converts it.
+template<typename Rtc, typename SysTickMs, uint8_t RESYNC_MINUTES = 10>
+class DS3231Clock {
+public:
+    constexpr DS3231Clock(Rtc& rtc)
+        : _rtc(rtc) {}
+
+    // Reads the chip and takes its time over, call it after init, on wake-up and after the time was set
+    void resync() {
+        _rtc.readData();
+        TimeStruct time = _rtc.getTime();
+        if(_synced) {
+            int32_t difference = secondsOfDay(_time) - secondsOfDay(time);
+            if(difference > SECONDS_PER_DAY / 2) {
+                difference -= SECONDS_PER_DAY;
+            } else if(difference < -SECONDS_PER_DAY / 2) {
+                difference += SECONDS_PER_DAY;
+            }
+            int32_t drift = difference * 1000;
+            // while the square wave runs, the chip's part of the second is the time since its last edge
+            uint32_t now = SysTickMs::getTicks();
+            uint32_t sinceEdge = now - _edgeTicks;
+            if(sinceEdge < EDGE_TIMEOUT_MS) {
+                drift += static_cast<int32_t>(_milliseconds + (now - _lastTicks)) - static_cast<int32_t>(sinceEdge);
+            }
+            _drift = _edgeDrift + drift;
+            _driftInterval = _secondsSinceResync;
+        }
+        // the phase within the second is kept while the local second still matches
+        if(!_synced || time.seconds != _time.seconds) {
+            _milliseconds = 0;
+        }
+        _time = time;
+        _date = _rtc.getDate();
+        _edgeDrift = 0;
+        _secondsSinceResync = 0;
+        _lastTicks = SysTickMs::getTicks();
+        _synced = true;
+    }
+    // One byte instead of a resync for wake-ups that can not have missed a second. While the chip
+    // still has the local second the time since the last update is not counted, the next chip second
+    // restarts the local one, anything else is resynced.
+    void checkSecond() {
+        uint8_t seconds = _rtc.readSeconds();
+        if(seconds == _time.seconds) {
+            _lastTicks = SysTickMs::getTicks();
+        } else if(seconds == (_time.seconds + 1) % 60) {
+            advanceSecond();
+            _milliseconds = 0;
+            _lastTicks = SysTickMs::getTicks();
+        } else {
+            resync();
+            _newSecond = true;
+        }
+    }
+    // Advances the local time, returns true once for every new second
+    bool update() {
+        uint32_t now = SysTickMs::getTicks();
+        _milliseconds += now - _lastTicks;
+        _lastTicks = now;
+        while(_milliseconds >= 1000) {
+            _milliseconds -= 1000;
+            advanceSecond();
+        }
+        if(_secondsSinceResync >= RESYNC_MINUTES * 60u) {
+            resync();
+            _newSecond = true;
+            _secondsSinceTemperature = 0;
+        } else if(_secondsSinceTemperature >= Rtc::TEMPERATURE_PERIOD) {
+            _rtc.readTemperatureAsync();
+            _secondsSinceTemperature = 0;
+        }
+        bool newSecond = _newSecond;
+        _newSecond = false;
+        return newSecond;
+    }
+    // Falling edge of the 1 Hz square wave, a chip second starts exactly here
+    void secondEdge() {
+        _edgeTicks = SysTickMs::getTicks();
+        // a second counted here is still reported by the next update()
+        _newSecond = update();
+        if(_milliseconds >= 500) {
+            // the local second is late
+            _edgeDrift -= static_cast<int32_t>(1000 - _milliseconds);
+            advanceSecond();
+        } else {
+            _edgeDrift += static_cast<int32_t>(_milliseconds);
+        }
+        _milliseconds = 0;
+    }
+    TimeStruct getTime() {
+        return _time;
+    }
+    DateStruct getDate() {
+        return _date;
+    }
+    int8_t getTemperature() {
+        return _rtc.getTemperature();
+    }
+    uint16_t getMilliseconds() {
+        return static_cast<uint16_t>(_milliseconds);
+    }
+    // Local minus chip time in ms found by the last resync, 1 s resolution unless the square wave is used.
+    // The local second may roll over shortly before the edge, the time since the edge counts it back.
+    int32_t getDrift() {
+        return _drift;
+    }
+    // seconds the last drift accumulated over
+    uint32_t getDriftInterval() {
+        return _driftInterval;
+    }
+private:
+    static constexpr int32_t SECONDS_PER_DAY = 24L * 60 * 60;
+    // an edge older than this does not tell the chip's phase any more
+    static constexpr uint32_t EDGE_TIMEOUT_MS = 2000;
+
+    Rtc& _rtc;
+    TimeStruct _time = {0, 0, 0};
+    DateStruct _date = {1, 1, 0};
+    uint32_t _milliseconds = 0;
+    uint32_t _lastTicks = 0;
+    uint32_t _edgeTicks = 0;
+    uint32_t _secondsSinceResync = 0;
+    uint8_t _secondsSinceTemperature = 0;
+    int32_t _edgeDrift = 0;
+    int32_t _drift = 0;
+    uint32_t _driftInterval = 0;
+    bool _synced = false;
+    bool _newSecond = false;
+
+    static int32_t secondsOfDay(TimeStruct time) {
+        return time.hours * 3600L + time.minutes * 60 + time.seconds;
+    }
+    static uint8_t daysInMonth(uint8_t month, uint8_t year) {
+        static const uint8_t days[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+        // the chip counts 2000-2099, every fourth year is a leap year there
+        if(month == 2 && year % 4 == 0) {
+            return 29;
+        }
+        return days[(month - 1) % 12];
+    }
+    void advanceSecond() {
+        _newSecond = true;
+        _secondsSinceResync++;
+        _secondsSinceTemperature++;
+        if(++_time.seconds < 60) {
+            return;
+        }
+        _time.seconds = 0;
+        if(++_time.minutes < 60) {
+            return;
+        }
+        _time.minutes = 0;
+        if(++_time.hours < 24) {
+            return;
+        }
+        _time.hours = 0;
+        if(++_date.date <= daysInMonth(_date.month, _date.year)) {
+            return;
+        }
+        _date.date = 1;
+        if(++_date.month <= 12) {
+            return;
+        }
+        _date.month = 1;
+        _date.year = (_date.year + 1) % 100;
+    }
+};
@@ -2,19 +2,107 @@
 
 #include <cstdint>
 #include "../../Periph/i2c_ch32v00x.hpp"
+#include "ssd1306_font.hpp"
 
 enum struct SSD1306MemoryAddressing {horizontal, vertical, page};
+enum struct SSD1306RectMode : uint8_t {fill, clear, invert};
 
-class SSD1306 {
+constexpr uint8_t SSD1306_WIDTH = 128;
+constexpr uint8_t SSD1306_PAGES = 8;
+
+// Bitmap in page layout, columns[page * width + x]
+struct SSD1306Bitmap {
+    const uint8_t* columns;
+    uint8_t width;
+    uint8_t pages;
+};
+
+// bits of the page covered by rows [y, y + height), 0 when the page is outside
+inline uint8_t ssd1306RectPageMask(uint8_t page, uint8_t y, uint8_t height) {
+    uint16_t first = y;
+    uint16_t end = static_cast<uint16_t>(y) + height;
+    uint16_t pageFirst = page * 8;
+    if(first < pageFirst) {
+        first = pageFirst;
+    }
+    if(end > pageFirst + 8) {
+        end = pageFirst + 8;
+    }
+    if(first >= end) {
+        return 0;
+    }
+    return (0xFF << (first - pageFirst)) & (0xFF >> (pageFirst + 8 - end));
+}
+inline uint8_t ssd1306ApplyRect(uint8_t value, uint8_t mask, SSD1306RectMode mode) {
+    switch(mode) {
+    case SSD1306RectMode::fill:
+        return value | mask;
+    case SSD1306RectMode::clear:
+        return value & ~mask;
+    default:
+        return value ^ mask;
+    }
+}
+
+// Frame buffer glyph copy. Whole bytes are written when y is page aligned, otherwise each page gets
+// the low bits of one glyph page and the high bits of the one above. The dirty range is updated once
+// per page. It runs from flash: the frame buffer leaves no RAM for it.
+inline void ssd1306BlitGlyph(uint8_t* buffer, uint8_t* dirtyFirst, uint8_t* dirtyLast,
+                                            uint8_t x, uint8_t y, const SSD1306Bitmap& glyph) {
+    uint8_t shift = y % 8;
+    uint8_t rows = shift == 0 ? glyph.pages : glyph.pages + 1;
+    uint8_t end = (x + glyph.width > SSD1306_WIDTH) ? SSD1306_WIDTH : x + glyph.width;
+    for(uint8_t part = 0; part < rows; part++) {
+        uint8_t page = y / 8 + part;
+        if(page >= SSD1306_PAGES) {
+            break;
+        }
+        const uint8_t* low = part < glyph.pages ? &glyph.columns[part * glyph.width] : nullptr;
+        const uint8_t* high = (shift != 0 && part > 0) ? &glyph.columns[(part - 1) * glyph.width] : nullptr;
+        uint8_t mask = (low ? (0xFF << shift) : 0) | (high ? (0xFF >> (8 - shift)) : 0);
+        uint8_t* row = &buffer[page * SSD1306_WIDTH];
+        uint8_t first = SSD1306_WIDTH;
+        uint8_t last = 0;
+        for(uint8_t i = x; i < end; i++) {
+            uint8_t bits = (low ? (low[i - x] << shift) : 0) | (high ? (high[i - x] >> (8 - shift)) : 0);
+            uint8_t value = (row[i] & ~mask) | (bits & mask);
+            if(value != row[i]) {
+                row[i] = value;
+                if(first == SSD1306_WIDTH) {
+                    first = i;
+                }
+                last = i;
+            }
+        }
+        if(first == SSD1306_WIDTH) {
+            continue;
+        }
+        if(dirtyFirst[page] > dirtyLast[page]) {
+            dirtyFirst[page] = first;
+            dirtyLast[page] = last;
+            continue;
+        }
+        if(first < dirtyFirst[page]) {
+            dirtyFirst[page] = first;
+        }
+        if(last > dirtyLast[page]) {
+            dirtyLast[page] = last;
+        }
+    }
+}
+
+// Panel set-up and window transfers shared by the frame buffer and the page streaming renderers
+template<typename I2cBus>
+class SSD1306Panel {
 public:
-    static constexpr uint32_t WIDTH = 128;
-    static constexpr uint32_t HEIGHT = 64;
-    static constexpr uint32_t BUFFER_SIZE = (WIDTH * HEIGHT / 8 + 8);
+    static constexpr uint32_t WIDTH = SSD1306_WIDTH;
+    static constexpr uint32_t HEIGHT = SSD1306_PAGES * 8;
     static constexpr uint8_t addressingMode = static_cast<uint8_t>(SSD1306MemoryAddressing::horizontal);
     static constexpr uint8_t contrast = 0xCF;
+    static constexpr uint8_t PAGES = HEIGHT / 8;
 
-    SSD1306(I2CInterface i2c, uint8_t devAddress, uint8_t* buffer)
-        : _i2c(i2c), _devAddress(devAddress), _buffer(buffer) {}
+    constexpr SSD1306Panel(uint8_t devAddress)
+        : _devAddress(devAddress) {}
 
     void init() {
         static const uint8_t initSequence[] = {
@@ -40,45 +128,260 @@ public:
         };
         writeCommands(initSequence, sizeof(initSequence));
     }
+    bool isUpdating() {
+        return _updating;
+    }
+    // Sleeps between the transfer interrupts. The flag is checked with interrupts disabled, WFI still
+    // wakes on the pending interrupt and it is handled once they are enabled again. A transfer stuck
+    // on the bus is aborted at its deadline, which ends the frame.
+    void waitForUpdate() {
+        __disable_irq();
+        while(isUpdating()) {
+            __WFI();
+            __enable_irq();
+            I2cBus::checkTimeout();
+            __disable_irq();
+        }
+        __enable_irq();
+    }
+protected:
+    uint8_t _devAddress;
+    volatile bool _updating = false;
+    // Co = 1 control bytes in front of each command, then a data stream until STOP
+    uint8_t _windowHeader[13] = {
+        0x80, 0x21, 0x80, 0x00, 0x80, WIDTH - 1, // column address
+        0x80, 0x22, 0x80, 0x00, 0x80, PAGES - 1, // page address
+        0x40
+    };
+
+    // Programs the column/page window and streams segments[1..count) after it in one transaction,
+    // segments[0] is taken by the window commands
+    bool submitWindow(uint8_t firstColumn, uint8_t lastColumn, uint8_t firstPage, uint8_t lastPage,
+                      I2cSegment* segments, uint8_t count, I2cCallback callback, void* context) {
+        _windowHeader[3] = firstColumn;
+        _windowHeader[5] = lastColumn;
+        _windowHeader[9] = firstPage;
+        _windowHeader[11] = lastPage;
+        segments[0] = {_windowHeader, sizeof(_windowHeader)};
+        return I2cBus::submit(I2cTransaction::writeSegments(_devAddress, segments, count, callback, context));
+    }
+    void writeCommands(const uint8_t* commands, uint8_t size) {
+        I2cBus::memoryWrite(_devAddress, 0x00, I2cMemAddrSize::oneByte, commands, size, 10);
+    }
+    void writeData(const uint8_t* data, uint32_t size) {
+        I2cBus::memoryWrite(_devAddress, 0x40, I2cMemAddrSize::oneByte, data, size, 10);
+    }
+};
+
+template<typename I2cBus>
+class SSD1306 : public SSD1306Panel<I2cBus> {
+    using Panel = SSD1306Panel<I2cBus>;
+public:
+    using Panel::WIDTH;
+    using Panel::HEIGHT;
+    using Panel::PAGES;
+    static constexpr uint32_t BUFFER_SIZE = (WIDTH * HEIGHT / 8 + 8);
+    // the buffer keeps its content between frames
+    static constexpr bool RETAINED_FRAME = true;
+
+    constexpr SSD1306(uint8_t devAddress, uint8_t* buffer)
+        : Panel(devAddress), _buffer(buffer) {
+        invalidate();
+    }
+
+    // Only bytes that really change are marked dirty, so redrawing identical content costs no bus traffic
     void fill(bool isWhite) {
-        for(uint32_t i = 0; i < BUFFER_SIZE; i++) {
-            _buffer[i] = isWhite?0xFF:0x00;
+        uint8_t value = isWhite?0xFF:0x00;
+        for(uint8_t page = 0; page < PAGES; page++) {
+            uint8_t* row = &_buffer[WIDTH * page];
+            uint8_t first = WIDTH;
+            uint8_t last = 0;
+            for(uint8_t x = 0; x < WIDTH; x++) {
+                if(row[x] != value) {
+                    row[x] = value;
+                    if(first == WIDTH) {
+                        first = x;
+                    }
+                    last = x;
+                }
+            }
+            if(first != WIDTH) {
+                markDirty(first, last, page);
+            }
         }
     }
+    constexpr void invalidate() {
+        for(uint8_t page = 0; page < PAGES; page++) {
+            markDirty(0, WIDTH - 1, page);
+        }
+    }
+    // Sends the dirty column range of each page, consecutive dirty pages share one window.
+    // The frame is streamed in the background, the buffer must not be modified until isUpdating() returns false.
     void updateScreen() {
-        uint8_t commands[] = {0xB0, 0x00, 0x10};
-        for(uint8_t i = 0; i < HEIGHT / 8; i++) {
-            commands[0] = 0xB0+i;
-            writeCommands(commands, sizeof(commands));
-            writeData(&_buffer[WIDTH * i], WIDTH);
+        this->waitForUpdate();
+        _nextPage = 0;
+        _updating = true;
+        sendNextDirty();
+    }
+    // Programs the column/page window once and streams its content in a single data transaction.
+    // The window is clipped to the panel, pages dirty only inside it are clean afterwards.
+    void updateWindow(uint8_t firstColumn, uint8_t lastColumn, uint8_t firstPage, uint8_t lastPage) {
+        if(lastColumn >= WIDTH) {
+            lastColumn = WIDTH - 1;
+        }
+        if(lastPage >= PAGES) {
+            lastPage = PAGES - 1;
+        }
+        if(firstColumn > lastColumn || firstPage > lastPage) {
+            return;
+        }
+        this->waitForUpdate();
+        for(uint8_t page = firstPage; page <= lastPage; page++) {
+            if(_dirtyFirst[page] >= firstColumn && _dirtyLast[page] <= lastColumn) {
+                _dirtyFirst[page] = WIDTH;
+                _dirtyLast[page] = 0;
+            }
+        }
+        _nextPage = PAGES;
+        _updating = true;
+        if(!sendWindow(firstColumn, lastColumn, firstPage, lastPage)) {
+            _updating = false;
         }
     }
     void drawPixel(uint8_t x, uint8_t y, bool isWhite) {
         if (x >= WIDTH || y >= HEIGHT) {
             return;
         }
-        if (isWhite) {
-            _buffer[x + (y / 8) * WIDTH] |= 1 << (y % 8);
-        } else {
-            _buffer[x + (y / 8) * WIDTH] &= ~(1 << (y % 8));
+        uint8_t& cell = _buffer[x + (y / 8) * WIDTH];
+        uint8_t value = isWhite ? (cell | (1 << (y % 8))) : (cell & ~(1 << (y % 8)));
+        if(value != cell) {
+            cell = value;
+            markDirty(x, x, y / 8);
         }
     }
     void invertPixel(uint8_t x, uint8_t y) {
-        if(_buffer[x + (y / 8) * WIDTH] & (1 << (y % 8))) {
-            drawPixel(x, y, false);
-        } else {
-            drawPixel(x, y, true);
+        if (x >= WIDTH || y >= HEIGHT) {
+            return;
+        }
+        _buffer[x + (y / 8) * WIDTH] ^= 1 << (y % 8);
+        markDirty(x, x, y / 8);
+    }
+    // Copies a bitmap in page layout (columns[page * width + x]), see ssd1306BlitGlyph
+    void blitGlyph(uint8_t x, uint8_t y, const uint8_t* columns, uint8_t width, uint8_t pages) {
+        ssd1306BlitGlyph(_buffer, _dirtyFirst, _dirtyLast, x, y, {columns, width, pages});
+    }
+    template<typename Glyph>
+    void drawGlyph(uint8_t x, uint8_t y, const Glyph& glyph) {
+        blitGlyph(x, y, &glyph.columns[0][0], Glyph::WIDTH, Glyph::PAGES);
+    }
+    void fillRect(uint8_t x, uint8_t y, uint8_t width, uint8_t height) {
+        drawRect(x, y, width, height, SSD1306RectMode::fill);
+    }
+    void clearRect(uint8_t x, uint8_t y, uint8_t width, uint8_t height) {
+        drawRect(x, y, width, height, SSD1306RectMode::clear);
+    }
+    void invertRect(uint8_t x, uint8_t y, uint8_t width, uint8_t height) {
+        drawRect(x, y, width, height, SSD1306RectMode::invert);
+    }
+    // one mask per page applied to whole bytes across the column span
+    void drawRect(uint8_t x, uint8_t y, uint8_t width, uint8_t height, SSD1306RectMode mode) {
+        if(x >= WIDTH || width == 0) {
+            return;
+        }
+        uint8_t last = (width > WIDTH - x) ? WIDTH - 1 : x + width - 1;
+        for(uint8_t page = y / 8; page < PAGES; page++) {
+            uint8_t mask = ssd1306RectPageMask(page, y, height);
+            if(mask == 0) {
+                break;
+            }
+            uint8_t* row = &_buffer[page * WIDTH];
+            bool changed = false;
+            for(uint8_t i = x; i <= last; i++) {
+                uint8_t value = ssd1306ApplyRect(row[i], mask, mode);
+                changed |= value != row[i];
+                row[i] = value;
+            }
+            if(changed) {
+                markDirty(x, last, page);
+            }
         }
     }
 private:
-    I2CInterface _i2c;
-    uint8_t _devAddress;
+    using Panel::_updating;
+    using Panel::_windowHeader;
+
     uint8_t* _buffer;
+    uint8_t _nextPage = PAGES;
+    // dirty column range per page, clean when first > last
+    uint8_t _dirtyFirst[PAGES] = {};
+    uint8_t _dirtyLast[PAGES] = {};
+    I2cSegment _windowSegments[PAGES + 1] = {};
 
-    void writeCommands(const uint8_t* commands, uint8_t size) {
-        _i2c.memoryWrite(_devAddress, 0x00, I2cMemAddrSize::oneByte, commands, size, 10);
+    constexpr bool isDirty(uint8_t page) const {
+        return _dirtyFirst[page] <= _dirtyLast[page];
     }
-    void writeData(const uint8_t* data, uint32_t size) {
-        _i2c.memoryWrite(_devAddress, 0x40, I2cMemAddrSize::oneByte, data, size, 10);
+    constexpr void markDirty(uint8_t first, uint8_t last, uint8_t page) {
+        if(!isDirty(page)) {
+            _dirtyFirst[page] = first;
+            _dirtyLast[page] = last;
+            return;
+        }
+        if(first < _dirtyFirst[page]) {
+            _dirtyFirst[page] = first;
+        }
+        if(last > _dirtyLast[page]) {
+            _dirtyLast[page] = last;
+        }
+    }
+    void sendNextDirty() {
+        uint8_t page = _nextPage;
+        while(page < PAGES && !isDirty(page)) {
+            page++;
+        }
+        if(page == PAGES) {
+            _updating = false;
+            return;
+        }
+        uint8_t firstPage = page;
+        uint8_t first = _dirtyFirst[page];
+        uint8_t last = _dirtyLast[page];
+        for(; page < PAGES && isDirty(page); page++) {
+            if(_dirtyFirst[page] < first) {
+                first = _dirtyFirst[page];
+            }
+            if(_dirtyLast[page] > last) {
+                last = _dirtyLast[page];
+            }
+            _dirtyFirst[page] = WIDTH;
+            _dirtyLast[page] = 0;
+        }
+        _nextPage = page;
+        if(!sendWindow(first, last, firstPage, page - 1)) {
+            _updating = false;
+        }
+    }
+    bool sendWindow(uint8_t firstColumn, uint8_t lastColumn, uint8_t firstPage, uint8_t lastPage) {
+        uint8_t count = 1;
+        uint16_t width = lastColumn - firstColumn + 1;
+        if(width == WIDTH) {
+            _windowSegments[count++] = {&_buffer[WIDTH * firstPage], static_cast<uint16_t>(WIDTH * (lastPage - firstPage + 1))};
+        } else {
+            for(uint8_t page = firstPage; page <= lastPage; page++) {
+                _windowSegments[count++] = {&_buffer[WIDTH * page + firstColumn], width};
+            }
+        }
+        return Panel::submitWindow(firstColumn, lastColumn, firstPage, lastPage, _windowSegments, count, windowSent, this);
+    }
+    static void windowSent(void* context, uint32_t error) {
+        SSD1306* self = static_cast<SSD1306*>(context);
+        if(error != 0) {
+            // not on the panel yet, it and the pages after it are sent with the next update
+            for(uint8_t page = self->_windowHeader[9]; page <= self->_windowHeader[11]; page++) {
+                self->markDirty(self->_windowHeader[3], self->_windowHeader[5], page);
+            }
+            self->_updating = false;
+            return;
+        }
+        self->sendNextDirty();
     }
 };
\ No newline at end of file
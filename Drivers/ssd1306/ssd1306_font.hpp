@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+
+// Glyph in SSD1306 memory layout: one byte per column and page, LSB is the top row of a page
+template<uint8_t GLYPH_WIDTH, uint8_t GLYPH_PAGES>
+struct SSD1306Glyph {
+    static constexpr uint8_t WIDTH = GLYPH_WIDTH;
+    static constexpr uint8_t PAGES = GLYPH_PAGES;
+    uint8_t columns[PAGES][WIDTH];
+};
+
+using SSD1306Glyph8x8 = SSD1306Glyph<8, 1>;
+using SSD1306Glyph16x16 = SSD1306Glyph<16, 2>;
+
+template<typename Glyph, uint8_t COUNT>
+struct SSD1306Font {
+    Glyph glyphs[COUNT];
+
+    constexpr const Glyph& operator[](uint8_t index) const {
+        return glyphs[index];
+    }
+};
+
+// Converts a row-major 8x8 font (8 rows, MSB left) into page bytes at compile time,
+// SCALE repeats every source pixel SCALE times in both directions
+template<typename Glyph, uint8_t SCALE, uint8_t COUNT>
+constexpr SSD1306Font<Glyph, COUNT> transposeFont(const uint8_t (&font)[COUNT][8]) {
+    static_assert(Glyph::WIDTH == 8 * SCALE && Glyph::PAGES == SCALE, "glyph size must match the scale");
+    SSD1306Font<Glyph, COUNT> result{};
+    for(uint8_t index = 0; index < COUNT; index++) {
+        for(uint8_t page = 0; page < Glyph::PAGES; page++) {
+            for(uint8_t x = 0; x < Glyph::WIDTH; x++) {
+                uint8_t value = 0;
+                for(uint8_t bit = 0; bit < 8; bit++) {
+                    uint8_t row = font[index][(page * 8 + bit) / SCALE];
+                    if(row & (1 << (7 - x / SCALE))) {
+                        value |= 1 << bit;
+                    }
+                }
+                result.glyphs[index].columns[page][x] = value;
+            }
+        }
+    }
+    return result;
+}
+
+template<uint8_t COUNT>
+constexpr SSD1306Font<SSD1306Glyph8x8, COUNT> transposeFont8x8(const uint8_t (&font)[COUNT][8]) {
+    return transposeFont<SSD1306Glyph8x8, 1>(font);
+}
+
+template<uint8_t COUNT>
+constexpr SSD1306Font<SSD1306Glyph16x16, COUNT> scaleFont16x16(const uint8_t (&font)[COUNT][8]) {
+    return transposeFont<SSD1306Glyph16x16, 2>(font);
+}
+
+// Keeps the first WIDTH columns of a glyph, e.g. for separators that only use the left part of their cell
+template<uint8_t WIDTH, uint8_t FROM_WIDTH, uint8_t PAGES>
+constexpr SSD1306Glyph<WIDTH, PAGES> cropGlyph(const SSD1306Glyph<FROM_WIDTH, PAGES>& glyph) {
+    static_assert(WIDTH <= FROM_WIDTH, "a glyph can only be cropped");
+    SSD1306Glyph<WIDTH, PAGES> result{};
+    for(uint8_t page = 0; page < PAGES; page++) {
+        for(uint8_t x = 0; x < WIDTH; x++) {
+            result.columns[page][x] = glyph.columns[page][x];
+        }
+    }
+    return result;
+}
+
+// ASCII to glyph index table, every code that is not in the font maps to the fallback glyph
+struct SSD1306CharMap {
+    static constexpr uint8_t SIZE = 128;
+    uint8_t index[SIZE];
+    uint8_t fallback;
+
+    constexpr uint8_t operator[](char c) const {
+        uint8_t code = static_cast<uint8_t>(c);
+        return code < SIZE ? index[code] : fallback;
+    }
+};
+
+// chars lists the font glyphs in order, e.g. "0123456789.:D"
+template<uint32_t N>
+constexpr SSD1306CharMap makeCharMap(const char (&chars)[N], uint8_t fallback) {
+    SSD1306CharMap result{};
+    for(uint8_t code = 0; code < SSD1306CharMap::SIZE; code++) {
+        result.index[code] = fallback;
+    }
+    for(uint32_t i = 0; i + 1 < N; i++) {
+        result.index[static_cast<uint8_t>(chars[i])] = i;
+    }
+    result.fallback = fallback;
+    return result;
+}
@@ -0,0 +1,212 @@
+#pragma once
+
+#include <cstdint>
+#include "../../Periph/ramfunc.hpp"
+#include "ssd1306.hpp"
+
+// Recorded draw call of SSD1306PageStream
+struct SSD1306DrawOp {
+    enum struct Type : uint8_t {glyph, rect};
+    struct Rect {
+        uint8_t width;
+        uint8_t height;
+        SSD1306RectMode mode;
+    };
+    Type type;
+    uint8_t x;
+    uint8_t y;
+    union {
+        SSD1306Bitmap glyph;
+        Rect rect;
+    };
+};
+
+// The page kernels run from the I2C interrupt for every page. They are free functions because
+// GCC ignores the section attribute on members of class templates.
+
+// the glyph pages that overlap the page, shifted the same way as ssd1306BlitGlyph
+static inline RAMFUNC void ssd1306RenderGlyph(uint8_t* pageBuffer, const SSD1306DrawOp& op, uint8_t page) {
+    uint8_t shift = op.y % 8;
+    for(uint8_t part = 0; part < op.glyph.pages; part++) {
+        uint8_t glyphPage = op.y / 8 + part;
+        bool lowPart = glyphPage == page;
+        if(!lowPart && (shift == 0 || glyphPage + 1 != page)) {
+            continue;
+        }
+        uint8_t mask = lowPart ? (0xFF << shift) : (0xFF >> (8 - shift));
+        const uint8_t* source = &op.glyph.columns[part * op.glyph.width];
+        for(uint8_t j = 0; j < op.glyph.width && op.x + j < SSD1306_WIDTH; j++) {
+            uint8_t value = lowPart ? (source[j] << shift) : (source[j] >> (8 - shift));
+            pageBuffer[op.x + j] = (pageBuffer[op.x + j] & ~mask) | (value & mask);
+        }
+    }
+}
+static inline RAMFUNC void ssd1306RenderRect(uint8_t* pageBuffer, const SSD1306DrawOp& op, uint8_t page) {
+    uint8_t mask = ssd1306RectPageMask(page, op.y, op.rect.height);
+    if(mask == 0) {
+        return;
+    }
+    for(uint8_t x = op.x; x < op.x + op.rect.width && x < SSD1306_WIDTH; x++) {
+        pageBuffer[x] = ssd1306ApplyRect(pageBuffer[x], mask, op.rect.mode);
+    }
+}
+static inline RAMFUNC void ssd1306RenderPage(uint8_t* pageBuffer, uint8_t page, uint8_t background,
+                                             const SSD1306DrawOp* ops, uint8_t count) {
+    RAMFUNC_EXPECTED();
+    for(uint8_t x = 0; x < SSD1306_WIDTH; x++) {
+        pageBuffer[x] = background;
+    }
+    for(uint8_t i = 0; i < count; i++) {
+        switch(ops[i].type) {
+        case SSD1306DrawOp::Type::glyph:
+            ssd1306RenderGlyph(pageBuffer, ops[i], page);
+            break;
+        case SSD1306DrawOp::Type::rect:
+            ssd1306RenderRect(pageBuffer, ops[i], page);
+            break;
+        }
+    }
+}
+
+// djb2 with the multiplication done by shift and add, RV32EC has no multiplier
+static inline uint32_t ssd1306PageSignature(const uint8_t* pageBuffer) {
+    uint32_t signature = 5381;
+    for(uint8_t x = 0; x < SSD1306_WIDTH; x++) {
+        signature = ((signature << 5) + signature) ^ pageBuffer[x];
+    }
+    return signature;
+}
+
+// Renders the screen from a display list one page at a time, right before the page is sent,
+// so only one page of RAM is needed instead of the whole frame buffer.
+// Draw calls only record operations: fill() starts a new list, which has to describe the whole screen.
+// A page that renders to the same signature as the last time it was sent is skipped.
+template<typename I2cBus, uint8_t MAX_OPS = 24>
+class SSD1306PageStream : public SSD1306Panel<I2cBus> {
+    using Panel = SSD1306Panel<I2cBus>;
+public:
+    using Panel::WIDTH;
+    using Panel::HEIGHT;
+    using Panel::PAGES;
+    // the caller provides a single page
+    static constexpr uint32_t BUFFER_SIZE = WIDTH;
+    static constexpr bool RETAINED_FRAME = false;
+
+    constexpr SSD1306PageStream(uint8_t devAddress, uint8_t* pageBuffer)
+        : Panel(devAddress), _pageBuffer(pageBuffer) {}
+
+    void fill(bool isWhite) {
+        _background = isWhite?0xFF:0x00;
+        _count = 0;
+    }
+    void blitGlyph(uint8_t x, uint8_t y, const uint8_t* columns, uint8_t width, uint8_t pages) {
+        Op* op = add(Op::Type::glyph, x, y);
+        if(op != nullptr) {
+            op->glyph = {columns, width, pages};
+        }
+    }
+    template<typename Glyph>
+    void drawGlyph(uint8_t x, uint8_t y, const Glyph& glyph) {
+        blitGlyph(x, y, &glyph.columns[0][0], Glyph::WIDTH, Glyph::PAGES);
+    }
+    void fillRect(uint8_t x, uint8_t y, uint8_t width, uint8_t height) {
+        drawRect(x, y, width, height, SSD1306RectMode::fill);
+    }
+    void clearRect(uint8_t x, uint8_t y, uint8_t width, uint8_t height) {
+        drawRect(x, y, width, height, SSD1306RectMode::clear);
+    }
+    void invertRect(uint8_t x, uint8_t y, uint8_t width, uint8_t height) {
+        drawRect(x, y, width, height, SSD1306RectMode::invert);
+    }
+    void drawRect(uint8_t x, uint8_t y, uint8_t width, uint8_t height, SSD1306RectMode mode) {
+        Op* op = add(Op::Type::rect, x, y);
+        if(op != nullptr) {
+            op->rect = {width, height, mode};
+        }
+    }
+    // Pages are rendered and sent from the completion callback of the previous page.
+    // The display list must not be modified until isUpdating() returns false.
+    void updateScreen() {
+        this->waitForUpdate();
+        _page = 0;
+        _continued = false;
+        _updating = true;
+        sendPage();
+    }
+    // the next update sends every page
+    void invalidate() {
+        _sentPages = 0;
+    }
+private:
+    using Panel::_updating;
+
+    using Op = SSD1306DrawOp;
+    static inline const uint8_t dataControl = 0x40;
+
+    uint8_t* _pageBuffer;
+    Op _ops[MAX_OPS] = {};
+    uint8_t _count = 0;
+    uint8_t _background = 0x00;
+    uint8_t _page = PAGES;
+    // the window of the previous page continues into this one
+    bool _continued = false;
+    // pages whose signature is on the panel, one bit per page
+    uint8_t _sentPages = 0;
+    uint32_t _signature = 0;
+    uint32_t _signatures[PAGES] = {};
+    I2cSegment _segments[2] = {};
+
+    Op* add(Op::Type type, uint8_t x, uint8_t y) {
+        if(_count == MAX_OPS) {
+            return nullptr;
+        }
+        Op* op = &_ops[_count++];
+        op->type = type;
+        op->x = x;
+        op->y = y;
+        return op;
+    }
+    // the first page sent programs the window from it to the bottom, the following pages continue
+    // the data stream in it until a page is skipped
+    void sendPage() {
+        for(; _page < PAGES; _page++) {
+            ssd1306RenderPage(_pageBuffer, _page, _background, _ops, _count);
+            _signature = ssd1306PageSignature(_pageBuffer);
+            if((_sentPages & (1 << _page)) == 0 || _signatures[_page] != _signature) {
+                break;
+            }
+            _continued = false;
+        }
+        if(_page == PAGES) {
+            _updating = false;
+            return;
+        }
+        bool queued;
+        if(!_continued) {
+            _segments[1] = {_pageBuffer, WIDTH};
+            queued = Panel::submitWindow(0, WIDTH - 1, _page, PAGES - 1, _segments, 2, pageSent, this);
+        } else {
+            _segments[0] = {&dataControl, 1};
+            _segments[1] = {_pageBuffer, WIDTH};
+            queued = I2cBus::submit(I2cTransaction::writeSegments(this->_devAddress, _segments, 2, pageSent, this));
+        }
+        if(!queued) {
+            _updating = false;
+        }
+    }
+    // a failed page ends the frame, what the panel got of it is unknown
+    static void pageSent(void* context, uint32_t error) {
+        SSD1306PageStream* self = static_cast<SSD1306PageStream*>(context);
+        uint8_t bit = 1 << self->_page;
+        if(error != 0) {
+            self->_sentPages &= ~bit;
+            self->_updating = false;
+            return;
+        }
+        self->_signatures[self->_page] = self->_signature;
+        self->_sentPages |= bit;
+        self->_page++;
+        self->_continued = true;
+        self->sendPage();
+    }
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include "ch32v00x.h"
+
+enum struct DmaChannel : uint8_t {ch1 = 1, ch2, ch3, ch4, ch5, ch6, ch7};
+enum struct DmaDirection : uint8_t {periphToMemory, memoryToPeriph};
+enum struct DmaPriority : uint8_t {low, medium, high, veryHigh};
+
+template<DmaChannel Channel, DmaDirection Direction, DmaPriority Priority = DmaPriority::medium>
+class Dma {
+private:
+    static constexpr uint8_t channel = static_cast<uint8_t>(Channel);
+    static constexpr uint32_t flagsShift = (channel - 1) * 4;
+    static constexpr uint32_t globalFlag = DMA_GIF1 << flagsShift;
+    static constexpr uint32_t completeFlag = DMA_TCIF1 << flagsShift;
+    static constexpr uint32_t errorFlag = DMA_TEIF1 << flagsShift;
+    // 8-bit peripheral and memory size, memory increment, no circular mode
+    static constexpr uint32_t config = DMA_CFGR1_MINC | DMA_CFGR1_TCIE | DMA_CFGR1_TEIE
+        | ((Direction == DmaDirection::memoryToPeriph) ? DMA_CFGR1_DIR : 0)
+        | (static_cast<uint32_t>(Priority) << 12);
+
+    static constexpr DMA_Channel_TypeDef* getInstance() {
+        if constexpr (Channel == DmaChannel::ch1) return DMA1_Channel1;
+        if constexpr (Channel == DmaChannel::ch2) return DMA1_Channel2;
+        if constexpr (Channel == DmaChannel::ch3) return DMA1_Channel3;
+        if constexpr (Channel == DmaChannel::ch4) return DMA1_Channel4;
+        if constexpr (Channel == DmaChannel::ch5) return DMA1_Channel5;
+        if constexpr (Channel == DmaChannel::ch6) return DMA1_Channel6;
+        if constexpr (Channel == DmaChannel::ch7) return DMA1_Channel7;
+    }
+public:
+    static constexpr IRQn_Type getIrq() {
+        return static_cast<IRQn_Type>(DMA1_Channel1_IRQn + channel - 1);
+    }
+    static void init() {
+        RCC->AHBPCENR |= RCC_DMA1EN;
+        stop();
+        NVIC_EnableIRQ(getIrq());
+    }
+    static void start(volatile void* periph, const void* memory, uint16_t size) {
+        getInstance()->CFGR = 0;
+        DMA1->INTFCR = globalFlag;
+        getInstance()->PADDR = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(periph));
+        getInstance()->MADDR = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(memory));
+        getInstance()->CNTR = size;
+        getInstance()->CFGR = config | DMA_CFGR1_EN;
+    }
+    static void stop() {
+        getInstance()->CFGR &= (~DMA_CFGR1_EN);
+        DMA1->INTFCR = globalFlag;
+    }
+    static bool isComplete() {
+        return (DMA1->INTFR & completeFlag) == completeFlag;
+    }
+    static bool isError() {
+        return (DMA1->INTFR & errorFlag) == errorFlag;
+    }
+    static uint16_t getRemaining() {
+        return static_cast<uint16_t>(getInstance()->CNTR);
+    }
+};
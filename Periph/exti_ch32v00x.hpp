@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include "ch32v00x.h"
+#include "gpio_ch32v00x.hpp"
+
+enum struct ExtiTrigger : uint8_t {rising = 0b01, falling = 0b10, both = 0b11};
+
+// External interrupt on a GPIO pin, the line number equals the pin number.
+// All lines share EXTI7_0_IRQHandler, which has to call irqHandler() of every line that is pending.
+template<GpioPort Port, GpioPin Pin, ExtiTrigger Trigger>
+class Exti {
+private:
+    static constexpr uint8_t line = static_cast<uint8_t>(Pin);
+    static constexpr uint32_t lineMask = (1 << line);
+    // 2 bits per line in AFIO->EXTICR
+    static constexpr uint32_t portSelect = (Port == GpioPort::A) ? 0b00 : ((Port == GpioPort::C) ? 0b10 : 0b11);
+
+    static inline volatile uint8_t _events = 0;
+    static inline uint8_t _taken = 0;
+    static inline void (*_onEvent)() = nullptr;
+public:
+    static void init() {
+        RCC->APB2PCENR |= RCC_AFIOEN;
+        AFIO->EXTICR = (AFIO->EXTICR & ~(0b11 << (line * 2))) | (portSelect << (line * 2));
+        if constexpr ((static_cast<uint8_t>(Trigger) & 0b01) != 0) EXTI->RTENR |= lineMask;
+        if constexpr ((static_cast<uint8_t>(Trigger) & 0b10) != 0) EXTI->FTENR |= lineMask;
+        EXTI->INTFR = lineMask;
+        EXTI->INTENR |= lineMask;
+        NVIC_EnableIRQ(EXTI7_0_IRQn);
+    }
+    static bool isPending() {
+        return (EXTI->INTFR & lineMask) != 0;
+    }
+    static void irqHandler() {
+        EXTI->INTFR = lineMask;
+        _events = _events + 1;
+        if(_onEvent != nullptr) {
+            _onEvent();
+        }
+    }
+    // called from the interrupt after an edge, e.g. to trigger the task that takes the event
+    static void setEventCallback(void (*callback)()) {
+        _onEvent = callback;
+    }
+    // Edges are counted by the interrupt and consumed here, so no edge is lost between the check and the clear
+    static bool hasEvent() {
+        return _events != _taken;
+    }
+    static bool takeEvent() {
+        uint8_t events = _events;
+        if(events == _taken) {
+            return false;
+        }
+        _taken = events;
+        return true;
+    }
+};
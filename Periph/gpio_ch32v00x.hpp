@@ -32,6 +32,9 @@ private:
         if constexpr (Port == GpioPort::D) return GPIOD;
     }
 public:
+    static constexpr GpioPort PORT = Port;
+    static constexpr GpioPin PIN = Pin;
+
     static void init() {
         // Включаем тактирование порта
         if constexpr (Port == GpioPort::A) RCC->APB2PCENR |= RCC_IOPAEN;
@@ -56,4 +59,27 @@ public:
     static void toggle() {
         getInstance()->OUTDR ^= pinMask;
     }
-};
\ No newline at end of file
+};
+// Pins of one port read with a single INDR access, bit n of read() is pin n of the port
+template<typename First, typename... Rest>
+class GpioGroup {
+private:
+    static constexpr GpioPort Port = First::PORT;
+    static_assert(((Rest::PORT == Port) && ...), "all pins of a group must be on the same port");
+
+    static constexpr GPIO_TypeDef* getInstance() {
+        if constexpr (Port == GpioPort::A) return GPIOA;
+        if constexpr (Port == GpioPort::C) return GPIOC;
+        if constexpr (Port == GpioPort::D) return GPIOD;
+    }
+public:
+    static constexpr uint32_t MASK = (1 << static_cast<uint8_t>(First::PIN)) | ((1 << static_cast<uint8_t>(Rest::PIN)) | ... | 0);
+
+    static void init() {
+        First::init();
+        (Rest::init(), ...);
+    }
+    static uint32_t read() {
+        return getInstance()->INDR & MASK;
+    }
+};
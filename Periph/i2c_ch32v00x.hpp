@@ -5,6 +5,7 @@
 #include <cassert>
 #include "rcc_ch32v00x.hpp"
 #include "systick_ch32v00x.hpp"
+#include "dma_ch32v00x.hpp"
 
 enum struct I2cInstance {i2c1, i2c2, i2c3, i2c4, i2c5, i2c6, i2c7, i2c8};
 enum struct I2cSpeed {standart, fast};
@@ -45,12 +46,81 @@ struct I2cParams {
     static constexpr uint8_t getOwnAddress() {return ownAddress;}
 };
 
+enum struct I2cDirection : uint8_t {write, read};
+
+using I2cCallback = void (*)(void* context, uint32_t error);
+
+struct I2cSegment {
+    const uint8_t* data;
+    uint16_t size;
+};
+
+// One queued transfer between START and STOP. Register accesses send the memory address first,
+// segment writes send the listed buffers back to back (e.g. SSD1306 control bytes, commands and data).
+// The buffers must stay valid until the callback is called.
+struct I2cTransaction {
+    uint8_t devAddress;
+    I2cDirection direction;
+    I2cMemAddrSize addressSize;
+    uint8_t segmentCount;
+    uint16_t memAddress;
+    uint16_t size;
+    uint8_t* data;
+    const I2cSegment* segments;
+    I2cCallback callback;
+    void* context;
+
+    static I2cTransaction write(uint8_t devAddress, uint16_t memAddress, I2cMemAddrSize addressSize, const uint8_t* data, uint16_t size, I2cCallback callback = nullptr, void* context = nullptr) {
+        return {devAddress, I2cDirection::write, addressSize, 0, memAddress, size, const_cast<uint8_t*>(data), nullptr, callback, context};
+    }
+    static I2cTransaction read(uint8_t devAddress, uint16_t memAddress, I2cMemAddrSize addressSize, uint8_t* data, uint16_t size, I2cCallback callback = nullptr, void* context = nullptr) {
+        return {devAddress, I2cDirection::read, addressSize, 0, memAddress, size, data, nullptr, callback, context};
+    }
+    static I2cTransaction writeSegments(uint8_t devAddress, const I2cSegment* segments, uint8_t segmentCount, I2cCallback callback = nullptr, void* context = nullptr) {
+        return {devAddress, I2cDirection::write, I2cMemAddrSize::oneByte, segmentCount, 0, 0, nullptr, segments, callback, context};
+    }
+};
+
 struct I2CInterface {
     bool (*acknowledgePolling)(uint8_t devAddress, uint32_t timeout);
     void (*transmit)(uint8_t devAddress, const uint8_t *data, uint16_t size, uint32_t timeout);
     void (*receive)(uint8_t devAddress, uint8_t *data, uint16_t size, uint32_t timeout);
     void (*memoryWrite)(uint8_t devAddress, uint16_t memAddress, I2cMemAddrSize addressSize, const uint8_t *data, uint16_t size, uint32_t timeout);
     void (*memoryRead)(uint8_t devAddress, uint16_t memAddress, I2cMemAddrSize addressSize, uint8_t *data, uint16_t size, uint32_t timeout);
+    bool (*submit)(const I2cTransaction& transaction);
+    bool (*isBusy)();
+    bool (*checkTimeout)();
+};
+
+// Bus type for the drivers that forwards to an I2CInterface chosen at run time.
+// Drivers bound to the I2c class directly get inlined calls instead.
+struct I2cInterfaceAdapter {
+    static inline I2CInterface instance;
+
+    static bool acknowledgePolling(uint8_t devAddress, uint32_t timeout) {
+        return instance.acknowledgePolling(devAddress, timeout);
+    }
+    static void transmit(uint8_t devAddress, const uint8_t *data, uint16_t size, uint32_t timeout) {
+        instance.transmit(devAddress, data, size, timeout);
+    }
+    static void receive(uint8_t devAddress, uint8_t *data, uint16_t size, uint32_t timeout) {
+        instance.receive(devAddress, data, size, timeout);
+    }
+    static void memoryWrite(uint8_t devAddress, uint16_t memAddress, I2cMemAddrSize addressSize, const uint8_t *data, uint16_t size, uint32_t timeout) {
+        instance.memoryWrite(devAddress, memAddress, addressSize, data, size, timeout);
+    }
+    static void memoryRead(uint8_t devAddress, uint16_t memAddress, I2cMemAddrSize addressSize, uint8_t *data, uint16_t size, uint32_t timeout) {
+        instance.memoryRead(devAddress, memAddress, addressSize, data, size, timeout);
+    }
+    static bool submit(const I2cTransaction& transaction) {
+        return instance.submit(transaction);
+    }
+    static bool isBusy() {
+        return instance.isBusy();
+    }
+    static bool checkTimeout() {
+        return instance.checkTimeout();
+    }
 };
 
 template<typename params, typename Rcc, typename SysTickMs>
@@ -69,7 +139,26 @@ public:
         ERROR_DMA_PARAM = 0x00000080U,
         WRONG_START = 0x00000200U
     };
+    static constexpr uint8_t QUEUE_SIZE = 4;
+    static constexpr uint16_t DMA_THRESHOLD = 8;
 private:
+    using TxDma = Dma<DmaChannel::ch6, DmaDirection::memoryToPeriph>;
+
+    enum struct AsyncPhase : uint8_t {idle, address, transmit, transmitDma, waitStop, waitRestart, restart, readAddress, readData};
+    static inline I2cTransaction queue[QUEUE_SIZE];
+    static inline volatile uint8_t queueHead = 0;
+    static inline volatile uint8_t queueTail = 0;
+    static inline volatile uint8_t queueCount = 0;
+    static inline volatile AsyncPhase phase = AsyncPhase::idle;
+    static inline uint16_t position;
+    static inline const uint8_t* txData;
+    static inline uint16_t txRemaining;
+    static inline uint8_t chunk;
+    static inline uint8_t memAddrBytes[2];
+    static inline uint8_t memAddrCount;
+    static inline uint32_t activeStart;
+    static inline uint32_t activeTimeout;
+
     static constexpr I2C_TypeDef* getInstance() {
         if constexpr(params::getInstance() == I2cInstance::i2c1) { return I2C1; }
         else { return nullptr; }
@@ -97,32 +186,6 @@ private:
         getInstance()->CTLR1 &= (~I2C_CTLR1_SWRST);
     }
 
-    static constexpr uint16_t getFrequency() {
-        constexpr uint16_t frequency = Rcc::getAPB1Clock() / 1000000;
-        static_assert((frequency >= 4) && (frequency <= 48), "Incorrect frerquency");
-        return frequency;
-    }
-    static constexpr uint16_t getCR2Config() {
-        return getFrequency();
-    }
-    static constexpr uint16_t getClockConfig() {
-        uint16_t result;
-        if constexpr (params::getSpeed() == I2cSpeed::fast) {
-            if constexpr (params::getDuty() == I2cDuty::duty_16_9) {
-                result = (uint16_t)(Rcc::getAPB1Clock() / (FAST_SPEED * 25));
-                result |= I2C_CKCFGR_DUTY;
-            } else {
-                result = (uint16_t)(Rcc::getAPB1Clock() / (FAST_SPEED * 3));
-            }
-            result |= I2C_CKCFGR_FS;
-        } else {
-            result = (uint16_t)(Rcc::getAPB1Clock() / (STANDART_SPEED << 1));
-        }
-        if ((result & I2C_CKCFGR_CCR) == 0) {
-            result |= 0x01;
-        }
-        return result;
-    }
     static bool timeIsUp(uint32_t tickStart, uint32_t timeout) {
         return (SysTickMs::getTicks() - tickStart >= timeout);
     }
@@ -141,8 +204,30 @@ private:
         }
         return false;
     }
+    // Sleeps like SSD1306Panel::waitForUpdate() until the queue is empty, the wait counts against the
+    // timeout of the blocking call. Only for calls outside of callbacks.
+    static bool waitForQueue(uint32_t tickStart, uint32_t timeout) {
+        for(;;) {
+            checkTimeout();
+            __disable_irq();
+            if(!isBusy()) {
+                __enable_irq();
+                return true;
+            }
+            if(timeIsUp(tickStart, timeout)) {
+                __enable_irq();
+                return false;
+            }
+            __WFI();
+            __enable_irq();
+        }
+    }
     static void masterPrepare(uint32_t tickStart, uint32_t timeout) {
-        while((getInstance()->STAR2 & I2C_STAR2_BUSY) == I2C_STAR2_BUSY) {
+        if(!waitForQueue(tickStart, timeout)) {
+            errorCode |= ERROR_TIMEOUT;
+            return;
+        }
+        while(isBusy() || (getInstance()->STAR2 & I2C_STAR2_BUSY) == I2C_STAR2_BUSY) {
             if(timeIsUp(tickStart, timeout)) {
                 errorCode |= ERROR_TIMEOUT;
                 return;
@@ -155,6 +240,10 @@ private:
         getInstance()->CTLR1 &= (~I2C_CTLR1_STOP);
     }
     static void masterTxMode(uint8_t address, uint32_t tickStart, uint32_t timeout) {
+        // the bus did not become free, a START now would break into the transfer on it
+        if(errorCode != ERROR_NONE) {
+            return;
+        }
         generateStart();
         while(!status(I2cEvent::masterModeSelect)) {
             if(timeIsUp(tickStart, timeout)) {
@@ -177,6 +266,10 @@ private:
         }
     }
     static void masterRxMode(uint8_t address, uint32_t tickStart, uint32_t timeout) {
+        // the bus did not become free, a START now would break into the transfer on it
+        if(errorCode != ERROR_NONE) {
+            return;
+        }
         generateStart();
         while(!status(I2cEvent::masterModeSelect)) {
             if(timeIsUp(tickStart, timeout)) {
@@ -229,15 +322,202 @@ private:
             --size;
         }
     }
+    static bool isEmpty(const I2cTransaction& transaction) {
+        if(transaction.direction == I2cDirection::read) {
+            return transaction.size == 0;
+        }
+        if(transaction.segments == nullptr) {
+            return false;
+        }
+        for(uint8_t i = 0; i < transaction.segmentCount; i++) {
+            if(transaction.segments[i].size != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+    static void lockIrq() {
+        NVIC_DisableIRQ(I2C1_EV_IRQn);
+        NVIC_DisableIRQ(I2C1_ER_IRQn);
+        NVIC_DisableIRQ(TxDma::getIrq());
+    }
+    static void unlockIrq() {
+        NVIC_EnableIRQ(I2C1_EV_IRQn);
+        NVIC_EnableIRQ(I2C1_ER_IRQn);
+        NVIC_EnableIRQ(TxDma::getIrq());
+    }
+    static void startNext() {
+        const I2cTransaction& transaction = queue[queueTail];
+        memAddrCount = 0;
+        uint32_t bytes = transaction.size;
+        if(transaction.segments == nullptr) {
+            if(transaction.addressSize == I2cMemAddrSize::twoBytes) {
+                memAddrBytes[memAddrCount++] = (transaction.memAddress>>8) & 0xFF;
+            }
+            memAddrBytes[memAddrCount++] = transaction.memAddress & 0xFF;
+        } else {
+            for(uint8_t i = 0; i < transaction.segmentCount; i++) {
+                bytes += transaction.segments[i].size;
+            }
+        }
+        // 8 bytes take 0.75 ms in standard mode
+        activeStart = SysTickMs::getTicks();
+        activeTimeout = ASYNC_TIMEOUT_MS + bytes / 8;
+        chunk = 0;
+        position = 0;
+        phase = AsyncPhase::address;
+        getInstance()->CTLR1 &= (~I2C_CTLR1_POS);
+        getInstance()->CTLR2 |= (I2C_CTLR2_ITEVTEN | I2C_CTLR2_ITERREN);
+        generateStart();
+    }
+    // Selects the next non-empty piece of the transmit phase: memory address, then payload or segments
+    static bool nextChunk(const I2cTransaction& transaction) {
+        for(;;) {
+            if(chunk == 0) {
+                txData = memAddrBytes;
+                txRemaining = memAddrCount;
+            } else if(transaction.direction == I2cDirection::read) {
+                return false;
+            } else if(transaction.segments == nullptr) {
+                if(chunk > 1) {
+                    return false;
+                }
+                txData = transaction.data;
+                txRemaining = transaction.size;
+            } else {
+                if(chunk > transaction.segmentCount) {
+                    return false;
+                }
+                txData = transaction.segments[chunk-1].data;
+                txRemaining = transaction.segments[chunk-1].size;
+            }
+            ++chunk;
+            if(txRemaining != 0) {
+                return true;
+            }
+        }
+    }
+    static void transmitNext(const I2cTransaction& transaction) {
+        I2C_TypeDef* i2c = getInstance();
+        if(!nextChunk(transaction)) {
+            // BTF tells that the last byte has left the shift register
+            i2c->CTLR2 &= (~I2C_CTLR2_ITBUFEN);
+            i2c->CTLR2 |= I2C_CTLR2_ITEVTEN;
+            phase = (transaction.direction == I2cDirection::read) ? AsyncPhase::waitRestart : AsyncPhase::waitStop;
+        } else if(txRemaining >= DMA_THRESHOLD) {
+            i2c->CTLR2 &= (~(I2C_CTLR2_ITBUFEN | I2C_CTLR2_ITEVTEN));
+            i2c->CTLR2 |= I2C_CTLR2_DMAEN;
+            phase = AsyncPhase::transmitDma;
+            TxDma::start(&i2c->DATAR, txData, txRemaining);
+        } else {
+            i2c->CTLR2 |= (I2C_CTLR2_ITEVTEN | I2C_CTLR2_ITBUFEN);
+            phase = AsyncPhase::transmit;
+        }
+    }
+    static void finish(uint32_t error) {
+        if(phase != AsyncPhase::readData || error != ERROR_NONE) {
+            generateStop();
+        }
+        getInstance()->CTLR2 &= (~(I2C_CTLR2_ITEVTEN | I2C_CTLR2_ITERREN | I2C_CTLR2_ITBUFEN | I2C_CTLR2_DMAEN));
+        complete(error);
+    }
+    static void complete(uint32_t error) {
+        I2cCallback callback = queue[queueTail].callback;
+        void* context = queue[queueTail].context;
+        queueTail = (queueTail + 1) % QUEUE_SIZE;
+        --queueCount;
+        phase = AsyncPhase::idle;
+        if(callback != nullptr) {
+            callback(context, error);
+        }
+        // the callback may already have started a newly submitted transaction
+        if(queueCount != 0 && phase == AsyncPhase::idle) {
+            startNext();
+        }
+    }
+    // SWRST clears a state machine stuck in the transfer together with the timing, which is written back
+    static void recover() {
+        uint16_t cr2Config = getInstance()->CTLR2 & I2C_CTLR2_FREQ;
+        uint16_t clockConfig = getInstance()->CKCFGR;
+        resetI2c();
+        getInstance()->CTLR2 = cr2Config;
+        getInstance()->CKCFGR = clockConfig;
+        enable();
+    }
 public:
     static inline uint32_t errorCode;
+    // the peripheral needs 4..48 MHz, the 16:9 duty cycle at least 10 MHz, and the bus must not run faster than its mode
+    static constexpr bool isClockValid(uint32_t apbClock) {
+        uint32_t frequency = apbClock / 1000000;
+        if(frequency < 4 || frequency > 48) {
+            return false;
+        }
+        if constexpr (params::getSpeed() == I2cSpeed::fast) {
+            if(params::getDuty() == I2cDuty::duty_16_9 && frequency < 10) {
+                return false;
+            }
+            return getBusSpeed(apbClock) <= FAST_SPEED;
+        }
+        return getBusSpeed(apbClock) <= STANDART_SPEED;
+    }
+    // rounded up, the bus may run slower than its mode but never faster
+    static constexpr uint32_t divideUp(uint32_t clock, uint32_t divider) {
+        return (clock + divider - 1) / divider;
+    }
+    // SCL frequency that getClockConfig() gives
+    static constexpr uint32_t getBusSpeed(uint32_t apbClock) {
+        uint32_t ccr = getClockConfig(apbClock) & I2C_CKCFGR_CCR;
+        if constexpr (params::getSpeed() == I2cSpeed::fast) {
+            return apbClock / (ccr * (params::getDuty() == I2cDuty::duty_16_9 ? 25 : 3));
+        }
+        return apbClock / (ccr * 2);
+    }
+    static constexpr uint16_t getCR2Config(uint32_t apbClock) {
+        return apbClock / 1000000;
+    }
+    static constexpr uint16_t getClockConfig(uint32_t apbClock) {
+        uint16_t result = 0;
+        if constexpr (params::getSpeed() == I2cSpeed::fast) {
+            if constexpr (params::getDuty() == I2cDuty::duty_16_9) {
+                result = (uint16_t)divideUp(apbClock, FAST_SPEED * 25);
+                result |= I2C_CKCFGR_DUTY;
+            } else {
+                result = (uint16_t)divideUp(apbClock, FAST_SPEED * 3);
+            }
+            result |= I2C_CKCFGR_FS;
+        } else {
+            result = (uint16_t)divideUp(apbClock, STANDART_SPEED << 1);
+        }
+        if ((result & I2C_CKCFGR_CCR) == 0) {
+            result |= 0x01;
+        }
+        return result;
+    }
+    // Follows a change of the bus clock, only while no transaction runs.
+    // The clock control register can only be written with the peripheral disabled.
+    static void setClock(uint16_t cr2Config, uint16_t clockConfig) {
+        disable();
+        getInstance()->CTLR2 = (getInstance()->CTLR2 & ~I2C_CTLR2_FREQ) | cr2Config;
+        getInstance()->CKCFGR = clockConfig;
+        enable();
+    }
     static void init() {
+        static_assert(isClockValid(Rcc::getAPB1Clock()), "Incorrect frerquency");
         RCC->APB2PCENR |= RCC_AFIOEN;
         enableClock();
         resetI2c();
-        getInstance()->CTLR2 = getCR2Config();
-        getInstance()->CKCFGR = getClockConfig();
+        getInstance()->CTLR2 = getCR2Config(Rcc::getAPB1Clock());
+        getInstance()->CKCFGR = getClockConfig(Rcc::getAPB1Clock());
         enable();
+        if constexpr(params::getInstance() == I2cInstance::i2c1) {
+            TxDma::init();
+            // the engine interrupts share one level so they never preempt each other
+            NVIC_SetPriority(I2C1_EV_IRQn, IRQ_PRIORITY);
+            NVIC_SetPriority(I2C1_ER_IRQn, IRQ_PRIORITY);
+            NVIC_SetPriority(TxDma::getIrq(), IRQ_PRIORITY);
+            NVIC_EnableIRQ(I2C1_EV_IRQn);
+            NVIC_EnableIRQ(I2C1_ER_IRQn);
+        }
     }
     static bool acknowledgePolling(uint8_t devAddress, uint32_t timeout) {
         uint32_t tickStart = SysTickMs::getTicks();
@@ -249,8 +529,10 @@ public:
                 generateStop();
                 return true;
             }
+            if((errorCode & ERROR_TIMEOUT) != 0) {
+                return false;
+            }
         }
-        return false;
     }
     static void transmit(uint8_t devAddress, const uint8_t *data, uint16_t size, uint32_t timeout) {
         uint32_t tickStart = SysTickMs::getTicks();
@@ -329,16 +611,153 @@ public:
         }
         generateStop(); 
     }
+    // Queues a transaction for the interrupt driven engine. Transactions run back to back,
+    // buffers of DMA_THRESHOLD bytes and more are moved through DMA.
+    // Blocking calls wait until the queue is empty, so only use them outside of callbacks.
+    // Reads of no byte and writes with nothing to send are refused.
+    static bool submit(const I2cTransaction& transaction) {
+        if(isEmpty(transaction)) {
+            return false;
+        }
+        lockIrq();
+        if(queueCount == QUEUE_SIZE) {
+            unlockIrq();
+            return false;
+        }
+        queue[queueHead] = transaction;
+        queueHead = (queueHead + 1) % QUEUE_SIZE;
+        ++queueCount;
+        if(phase == AsyncPhase::idle) {
+            startNext();
+        }
+        unlockIrq();
+        return true;
+    }
+    static bool isBusy() {
+        return queueCount != 0;
+    }
+    // Aborts the active transaction once its deadline has passed: STOP, a reset of the peripheral and
+    // ERROR_TIMEOUT to its callback. The waits call it, returns true if a transaction was aborted.
+    static bool checkTimeout() {
+        lockIrq();
+        bool expired = phase != AsyncPhase::idle && timeIsUp(activeStart, activeTimeout);
+        if(expired) {
+            TxDma::stop();
+            generateStop();
+            recover();
+            complete(ERROR_TIMEOUT);
+        }
+        unlockIrq();
+        return expired;
+    }
+    static void eventIrqHandler() {
+        I2C_TypeDef* i2c = getInstance();
+        I2cTransaction& transaction = queue[queueTail];
+        uint16_t status1 = i2c->STAR1;
+        if((status1 & I2C_STAR1_SB) == I2C_STAR1_SB) {
+            if(phase == AsyncPhase::restart) {
+                i2c->DATAR = static_cast<uint8_t>(transaction.devAddress | I2C_OADDR1_ADD0);
+                phase = AsyncPhase::readAddress;
+            } else {
+                i2c->DATAR = static_cast<uint8_t>(transaction.devAddress & (~I2C_OADDR1_ADD0));
+            }
+            return;
+        }
+        if((status1 & I2C_STAR1_ADDR) == I2C_STAR1_ADDR) {
+            if(phase == AsyncPhase::readAddress) {
+                // NACK and STOP for a single byte have to be set before ADDR is cleared
+                if(transaction.size == 1) {
+                    i2c->CTLR1 &= (~I2C_CTLR1_ACK);
+                    (void)i2c->STAR2;
+                    generateStop();
+                } else {
+                    i2c->CTLR1 |= I2C_CTLR1_ACK;
+                    (void)i2c->STAR2;
+                }
+                phase = AsyncPhase::readData;
+                i2c->CTLR2 |= I2C_CTLR2_ITBUFEN;
+            } else {
+                (void)i2c->STAR2;
+                transmitNext(transaction);
+            }
+            return;
+        }
+        switch(phase) {
+        case AsyncPhase::transmit:
+            if((status1 & I2C_STAR1_TXE) == I2C_STAR1_TXE) {
+                i2c->DATAR = *txData++;
+                if(--txRemaining == 0) {
+                    transmitNext(transaction);
+                }
+            }
+            break;
+        case AsyncPhase::waitRestart:
+            if((status1 & I2C_STAR1_BTF) == I2C_STAR1_BTF) {
+                phase = AsyncPhase::restart;
+                generateStart();
+            }
+            break;
+        case AsyncPhase::waitStop:
+            if((status1 & I2C_STAR1_BTF) == I2C_STAR1_BTF) {
+                finish(ERROR_NONE);
+            }
+            break;
+        case AsyncPhase::readData:
+            if((status1 & I2C_STAR1_RXNE) == I2C_STAR1_RXNE) {
+                transaction.data[position++] = i2c->DATAR;
+                uint16_t remaining = transaction.size - position;
+                if(remaining == 1) {
+                    i2c->CTLR1 &= (~I2C_CTLR1_ACK);
+                    generateStop();
+                } else if(remaining == 0) {
+                    finish(ERROR_NONE);
+                }
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    static void errorIrqHandler() {
+        uint16_t status1 = getInstance()->STAR1;
+        uint32_t error = ERROR_NONE;
+        if(status1 & I2C_STAR1_BERR) { error |= ERROR_BERR; }
+        if(status1 & I2C_STAR1_ARLO) { error |= ERROR_ARLO; }
+        if(status1 & I2C_STAR1_AF) { error |= ERROR_AF; }
+        if(status1 & I2C_STAR1_OVR) { error |= ERROR_OVR; }
+        getInstance()->STAR1 &= (~(I2C_STAR1_BERR | I2C_STAR1_ARLO | I2C_STAR1_AF | I2C_STAR1_OVR));
+        TxDma::stop();
+        if(phase != AsyncPhase::idle) {
+            finish(error);
+        }
+    }
+    // called from the DMA channel interrupt once the last byte of a chunk is written to DATAR
+    static void dmaTxIrqHandler() {
+        bool isError = TxDma::isError();
+        TxDma::stop();
+        getInstance()->CTLR2 &= (~I2C_CTLR2_DMAEN);
+        if(isError) {
+            finish(ERROR_DMA);
+            return;
+        }
+        transmitNext(queue[queueTail]);
+    }
     static I2CInterface getInterface() {
         return {acknowledgePolling,
                 transmit,
                 receive,
                 memoryWrite,
-                memoryRead};
+                memoryRead,
+                submit,
+                isBusy,
+                checkTimeout};
     }
 private:
     static constexpr uint32_t STANDART_SPEED = 100000; 
     static constexpr uint32_t FAST_SPEED = 400000; 
     static constexpr uint32_t TIMEOUT = 10000;
+    // a queued transaction gets this plus 1 ms per 8 bytes
+    static constexpr uint32_t ASYNC_TIMEOUT_MS = 10;
     static constexpr uint32_t FLAG_MASK = 0x00FFFFFF;
+    static constexpr uint8_t IRQ_PRIORITY = 0x80;
 };
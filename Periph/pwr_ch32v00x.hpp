@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include "ch32v00x.h"
+
+#define PWR_AWUCSR_AWUEN                          ((uint32_t)0x00000002)
+#define PWR_AWUPSC_DIV2048                        ((uint32_t)0x0000000C)
+#define PWR_AWUWR_MASK                            ((uint32_t)0x0000003F)
+#define PFIC_SCTLR_SLEEPDEEP                      ((uint32_t)0x00000004)
+
+enum struct PowerState : uint8_t {run, sleep, standby, COUNT};
+enum struct WakeSource : uint8_t {awu, exti, COUNT};
+
+// Standby mode with the auto wake-up timer. All clocks stop, RAM and registers are kept and the
+// program continues after the WFI, so only the system clock has to be set up again.
+// Any enabled EXTI line (buttons, RTC square wave) ends the standby early.
+template<typename Rcc, typename SysTickMs>
+class Pwr {
+private:
+    static constexpr uint32_t LSI_CLOCK = 128000;
+    static constexpr uint32_t AWU_PRESCALER = 2048;
+    // the AWU event comes in on EXTI line 9
+    static constexpr uint32_t AWU_LINE = (1 << 9);
+
+    static inline uint32_t _standbyMs = 0;
+    static inline uint32_t _wakeUps[static_cast<uint8_t>(WakeSource::COUNT)] = {};
+public:
+    // resolution of standby(), 16 ms
+    static constexpr uint32_t AWU_STEP_MS = AWU_PRESCALER * 1000 / LSI_CLOCK;
+    static constexpr uint32_t MAX_STANDBY_MS = PWR_AWUWR_MASK * AWU_STEP_MS;
+
+    static void init() {
+        RCC->APB1PCENR |= RCC_PWREN;
+        RCC->RSTSCKR |= RCC_LSION;
+        while((RCC->RSTSCKR & RCC_LSIRDY) == 0) {}
+        PWR->AWUPSC = PWR_AWUPSC_DIV2048;
+        EXTI->FTENR |= AWU_LINE;
+        EXTI->INTFR = AWU_LINE;
+        EXTI->INTENR |= AWU_LINE;
+        NVIC_EnableIRQ(AWU_IRQn);
+    }
+    // Sleeps in standby for ms, rounded up to AWU_STEP_MS, or until an EXTI line fires.
+    // SysTick stands still meanwhile, its ticks are advanced by the standby time afterwards.
+    // The LSI is only accurate to a few percent and the time of an early wake-up is not known
+    // (half of the programmed time is taken), time keeping has to resync after it.
+    // Like SysTickMs::idle() the WFI runs with interrupts disabled, the interrupt that ended the
+    // standby is taken on return with interrupts enabled.
+    static WakeSource standby(uint32_t ms) {
+        uint32_t window = (ms + AWU_STEP_MS - 1) / AWU_STEP_MS;
+        if(window == 0) {
+            window = 1;
+        } else if(window > PWR_AWUWR_MASK) {
+            window = PWR_AWUWR_MASK;
+        }
+        __disable_irq();
+        EXTI->INTFR = AWU_LINE;
+        PWR->AWUWR = window;
+        // enabling the AWU restarts its counter from 0
+        PWR->AWUCSR = 0;
+        PWR->AWUCSR = PWR_AWUCSR_AWUEN;
+        PWR->CTLR |= PWR_CTLR_PDDS;
+        NVIC->SCTLR |= PFIC_SCTLR_SLEEPDEEP;
+        __WFI();
+        NVIC->SCTLR &= ~PFIC_SCTLR_SLEEPDEEP;
+        PWR->CTLR &= ~PWR_CTLR_PDDS;
+        PWR->AWUCSR = 0;
+        // the core wakes up on HSI, a PLL or HSE has to be started again
+        Rcc::init();
+
+        // the AWU flag stays pending until the handler runs
+        WakeSource source = (EXTI->INTFR & AWU_LINE) ? WakeSource::awu : WakeSource::exti;
+        uint32_t slept = window * AWU_STEP_MS;
+        if(source != WakeSource::awu) {
+            slept /= 2;
+        }
+        SysTickMs::addTicks(slept);
+        _standbyMs += slept;
+        _wakeUps[static_cast<uint8_t>(source)]++;
+        __enable_irq();
+        return source;
+    }
+    static void awuIrqHandler() {
+        EXTI->INTFR = AWU_LINE;
+    }
+    // Time spent in every state since start up, weighted with the datasheet currents it gives the average current
+    static uint32_t getResidencyMs(PowerState state) {
+        switch(state) {
+        case PowerState::run:
+            return SysTickMs::getActiveMs() - _standbyMs;
+        case PowerState::sleep:
+            return SysTickMs::getIdleMs();
+        case PowerState::standby:
+            return _standbyMs;
+        default:
+            return 0;
+        }
+    }
+    static uint32_t getWakeUps(WakeSource source) {
+        return _wakeUps[static_cast<uint8_t>(source)];
+    }
+};
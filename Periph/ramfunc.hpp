@@ -0,0 +1,17 @@
+#pragma once
+
+// Places a function in .ramfunc, which the startup code copies from flash to RAM. Code in RAM runs
+// without the flash wait state the 48 MHz clock needs. Never inlined, an inlined copy would run from flash.
+// Every byte comes out of the 2 KB of RAM, keep it to the loops that run for every pixel.
+// The gain and the cost are estimates, not measured on an RV32EC build: about 15-25 % of the time of
+// a column byte in the page kernels, one wait cycle per flash fetch and taken branch, for about 500 B
+// of RAM with page streaming. getWorstCaseUs() of the render task gives the real time on the board.
+// Only use it on static inline free functions: GCC ignores the section on members of class templates
+// and puts inline members of classes in comdat groups.
+#ifndef RAMFUNC
+#define RAMFUNC __attribute__((section(".ramfunc"), noinline))
+#endif
+
+// Put in the body of a RAMFUNC function: once the function is emitted, linker.ld fails the link
+// when .ramfunc comes out empty
+#define RAMFUNC_EXPECTED() asm(".weak __ramfunc_expected\n\t.set __ramfunc_expected, 1")
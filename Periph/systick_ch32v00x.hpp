@@ -14,22 +14,142 @@ class SysTickMs {
 private:
     static constexpr uint32_t TICK_MS = 1000;
     static constexpr uint32_t PERIOD = SysClock::getAHBClock() / TICK_MS / 8;
+    // longest single sleep, keeps the compare value far away from overflow
+    static constexpr uint32_t MAX_SLEEP_MS = 1000;
+    // counts left in the current millisecond below which the tick is not stretched,
+    // idle() checks again after writing the compare
+    static constexpr uint32_t GUARD_COUNTS = 16;
+
+    // counts per millisecond of the current HCLK, changed by setClock()
+    static inline uint32_t _countsPerMs = PERIOD;
+    // milliseconds covered by the current compare period, more than 1 only while idle() sleeps
+    static inline volatile uint32_t _period = 1;
+    static inline volatile uint32_t _idleMs = 0;
+    static inline uint32_t _idleCounts = 0;
+
+    static bool isTickPending() {
+        return (SysTick->SR & 1) != 0;
+    }
+    static void addIdle(uint32_t counts) {
+        _idleCounts += counts;
+        _idleMs = _idleMs + _idleCounts / _countsPerMs;
+        _idleCounts %= _countsPerMs;
+    }
 public:
+    // the counter runs on HCLK/8
+    static constexpr uint32_t countsPerMs(uint32_t ahbClock) {
+        return ahbClock / TICK_MS / 8;
+    }
+
     static inline volatile uint32_t _ticks = 0;
     static void init() {
         SysTick->CNT = 0;
-        SysTick->CMP = PERIOD - 1;
+        SysTick->CMP = _countsPerMs - 1;
         SysTick->CTLR = STK_CTLR_STE | STK_CTLR_STRE | STK_CTLR_STIE;
         NVIC_EnableIRQ(SysTicK_IRQn);
     }
+    // Follows a change of HCLK, the position within the current millisecond is kept.
+    // Not while idle() sleeps. Keeps the interrupt state of the caller, the idle path calls it disabled.
+    static void setClock(uint32_t ahbClock) {
+        uint32_t counts = countsPerMs(ahbClock);
+        uint32_t mstatus = __get_MSTATUS();
+        __disable_irq();
+        SysTick->CNT = SysTick->CNT * counts / _countsPerMs;
+        SysTick->CMP = counts - 1;
+        _idleCounts = _idleCounts * counts / _countsPerMs;
+        _countsPerMs = counts;
+        __set_MSTATUS(mstatus);
+    }
     static void delayMs(uint32_t ms) {
         uint32_t start = getTicks();
-        while (getTicks() - start < ms) {}
+        while (getTicks() - start < ms) {
+            idle(ms - (getTicks() - start));
+        }
+    }
+    // Sleeps with WFI until any interrupt or at most ms milliseconds. The 1 ms tick is stretched to the
+    // whole sleep, so a long wait costs one wake-up instead of one per millisecond; getTicks() stays exact.
+    // WFI runs with interrupts disabled and still wakes on a pending one, which is taken on return.
+    // A caller can check its flags with interrupts disabled and then call idle() without missing an
+    // interrupt in between. Interrupts are enabled on return.
+    static void idle(uint32_t ms) {
+        if(ms > MAX_SLEEP_MS) {
+            ms = MAX_SLEEP_MS;
+        }
+        // a library call on RV32EC, done before the counter is sampled
+        uint32_t compare = ms * _countsPerMs - 1;
+        __disable_irq();
+        uint32_t start = SysTick->CNT;
+        uint32_t periodCounts = _countsPerMs;
+        // not when the current millisecond is about to end, its tick must count 1
+        if(ms > 1 && start + GUARD_COUNTS < _countsPerMs && !isTickPending()) {
+            SysTick->CMP = compare;
+            if(isTickPending()) {
+                // the millisecond ended before the compare was written, the counter restarted with 1 ms
+                SysTick->CMP = _countsPerMs - 1;
+            } else {
+                _period = ms;
+                periodCounts = compare + 1;
+            }
+        }
+        __WFI();
+        if(!isTickPending()) {
+            // woken by another interrupt: account the whole milliseconds and return to the 1 ms tick
+            uint32_t now = SysTick->CNT;
+            if(_period != 1) {
+                uint32_t elapsed = now / _countsPerMs;
+                _ticks = _ticks + elapsed;
+                // from the sample, a new read may be in the next millisecond and end up above the compare
+                SysTick->CNT = now - elapsed * _countsPerMs;
+                SysTick->CMP = _countsPerMs - 1;
+                _period = 1;
+            }
+            addIdle(now - start);
+        } else {
+            // the period ran out and the counter restarted from 0, the tick interrupt counts it
+            addIdle(periodCounts - start + SysTick->CNT);
+        }
+        __enable_irq();
     }
     static uint32_t getTicks() {
         return _ticks;
     }
+    // Fine grained time stamp for measuring short intervals, in microseconds so it does not depend
+    // on the clock profile. Resolution 8 HCLK cycles, wraps after 71 minutes. Not from interrupts,
+    // the counter may run beyond one millisecond while idle() sleeps. Keeps the interrupt state of the caller.
+    static uint32_t getMicros() {
+        uint32_t mstatus = __get_MSTATUS();
+        __disable_irq();
+        uint32_t ticks = _ticks;
+        uint32_t count = SysTick->CNT;
+        if(isTickPending()) {
+            // the counter restarted but the tick is not counted yet
+            ticks += _period;
+            count = SysTick->CNT;
+        }
+        uint32_t countsPerMs = _countsPerMs;
+        __set_MSTATUS(mstatus);
+        return ticks * 1000 + count * 1000 / countsPerMs;
+    }
+    // time spent in idle() since start up, the rest of getTicks() was spent running
+    static uint32_t getIdleMs() {
+        return _idleMs;
+    }
+    static uint32_t getActiveMs() {
+        return getTicks() - getIdleMs();
+    }
+    // Accounts time the counter stood still, e.g. in standby where the core clock is off.
+    // Keeps the interrupt state of the caller, Pwr::standby() calls it disabled.
+    static void addTicks(uint32_t ms) {
+        uint32_t mstatus = __get_MSTATUS();
+        __disable_irq();
+        _ticks = _ticks + ms;
+        __set_MSTATUS(mstatus);
+    }
     static void incrementTicks(void) {
-        ++_ticks;
+        _ticks = _ticks + _period;
+        if(_period != 1) {
+            SysTick->CMP = _countsPerMs - 1;
+            _period = 1;
+        }
     }
 };
\ No newline at end of file
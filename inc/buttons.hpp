@@ -0,0 +1,237 @@
+#pragma once
+
+#include <cstdint>
+#include "gpio_ch32v00x.hpp"
+#include "exti_ch32v00x.hpp"
+
+enum struct ButtonEventType : uint8_t {press, release, longPress, repeat};
+
+struct ButtonEvent {
+    uint8_t button;         // index in the Pins list
+    ButtonEventType type;
+};
+
+// Debounces up to 32 inputs in parallel, bit by bit. Every bit has a 2-bit counter whose two bits are
+// kept in two words, an input takes a new state after SAMPLES equal samples that differ from the old one.
+class VerticalDebounce {
+public:
+    static constexpr uint8_t SAMPLES = 4;
+
+    constexpr VerticalDebounce(uint32_t state = 0)
+        : _state(state) {}
+
+    // Takes a sample (set bit = active) and returns the bits whose state changed
+    uint32_t update(uint32_t sample) {
+        uint32_t delta = sample ^ _state;
+        // counts down from 3 while the input differs from the state, back to 3 when it does not
+        _count0 = ~(_count0 & delta);
+        _count1 = _count0 ^ (_count1 & delta);
+        uint32_t toggle = delta & _count0 & _count1;
+        _state ^= toggle;
+        _changed = toggle;
+        return toggle;
+    }
+    // inputs that became active with the last sample
+    uint32_t getPressed() const {
+        return _changed & _state;
+    }
+    uint32_t getReleased() const {
+        return _changed & ~_state;
+    }
+    uint32_t getHeld() const {
+        return _state;
+    }
+    // inputs that differ from their state, their counters are running
+    uint32_t getPending(uint32_t sample) const {
+        return sample ^ _state;
+    }
+private:
+    uint32_t _state;
+    uint32_t _changed = 0;
+    uint32_t _count0 = UINT32_MAX;
+    uint32_t _count1 = UINT32_MAX;
+};
+
+// Buttons to ground with pull-ups on one port, one EXTI line per pin on both edges.
+// The port is read once per sample and debounced by VerticalDebounce. Sampling only runs while
+// an input differs from its state, an edge starts it. All lines share EXTI7_0_IRQHandler,
+// which has to call irqHandler().
+template<typename SysTickMs, typename... Pins>
+class Buttons {
+public:
+    static constexpr uint8_t COUNT = sizeof...(Pins);
+    static constexpr uint32_t SAMPLE_MS = 5;
+    // a change is reported with the SAMPLES-th equal sample, 15 ms after the first of them in whole ticks:
+    // up to 20 ms after the contact settled, less when a bounce fell between two samples
+    static constexpr uint32_t DEBOUNCE_MS = SAMPLE_MS * VerticalDebounce::SAMPLES;
+    static constexpr uint32_t LONG_PRESS_MS = 1000;
+    // hold-to-repeat: 10 per second after the delay, 30 per second once held for REPEAT_FAST_AFTER_MS
+    static constexpr uint32_t REPEAT_DELAY_MS = 400;
+    static constexpr uint32_t REPEAT_SLOW_MS = 100;
+    static constexpr uint32_t REPEAT_FAST_MS = 33;
+    static constexpr uint32_t REPEAT_FAST_AFTER_MS = 2000;
+    static constexpr uint8_t QUEUE_SIZE = 8;
+private:
+    using Group = GpioGroup<Pins...>;
+    template<typename Pin>
+    using Line = Exti<Pin::PORT, Pin::PIN, ExtiTrigger::both>;
+
+    static constexpr uint32_t PIN_MASKS[COUNT] = {(1UL << static_cast<uint8_t>(Pins::PIN))...};
+
+    static inline volatile bool _edge = false;
+    static inline void (*_onEdge)() = nullptr;
+    static inline VerticalDebounce _debounce;
+    static inline bool _sampling = false;
+    static inline uint32_t _lastSample = 0;
+    static inline uint32_t _longReported = 0;
+    static inline uint32_t _repeat = 0;
+    static inline uint32_t _pressTime[COUNT] = {};
+    static inline uint32_t _nextRepeat[COUNT] = {};
+    // filled and emptied by the main loop only
+    static inline ButtonEvent _queue[QUEUE_SIZE];
+    static inline uint8_t _head = 0;
+    static inline uint8_t _count = 0;
+    static inline uint32_t _dropped = 0;
+
+    // set bit = pressed, in port bit positions
+    static uint32_t sample() {
+        return ~Group::read() & Group::MASK;
+    }
+    template<typename Pin>
+    static bool edge() {
+        if(!Line<Pin>::isPending()) {
+            return false;
+        }
+        Line<Pin>::irqHandler();
+        return true;
+    }
+    static void push(uint8_t button, ButtonEventType type) {
+        if(_count == QUEUE_SIZE) {
+            _dropped++;
+            return;
+        }
+        _queue[(_head + _count) % QUEUE_SIZE] = {button, type};
+        _count++;
+    }
+    static void wakeIn(uint32_t& next, uint32_t ms) {
+        if(next == 0 || ms < next) {
+            next = ms;
+        }
+    }
+    // queues the repeats that are due and returns the time to the next one
+    static uint32_t repeat(uint8_t button, uint32_t now) {
+        if(static_cast<int32_t>(now - _nextRepeat[button]) >= 0) {
+            push(button, ButtonEventType::repeat);
+            uint32_t interval = (now - _pressTime[button] < REPEAT_FAST_AFTER_MS) ? REPEAT_SLOW_MS : REPEAT_FAST_MS;
+            _nextRepeat[button] += interval;
+            // a late update does not queue a burst of repeats
+            if(static_cast<int32_t>(now - _nextRepeat[button]) >= 0) {
+                _nextRepeat[button] = now + interval;
+            }
+        }
+        return _nextRepeat[button] - now;
+    }
+public:
+    static void init() {
+        Group::init();
+        _debounce = VerticalDebounce(sample());
+        (Line<Pins>::init(), ...);
+    }
+    // called from the interrupt after an edge, e.g. to trigger the task that runs update()
+    static void setEdgeCallback(void (*callback)()) {
+        _onEdge = callback;
+    }
+    // a held button sends repeat events
+    static void setRepeat(uint8_t button, bool enable) {
+        if(enable) {
+            _repeat |= PIN_MASKS[button];
+        } else {
+            _repeat &= ~PIN_MASKS[button];
+        }
+    }
+    static void irqHandler() {
+        if((edge<Pins>() | ...)) {
+            _edge = true;
+            if(_onEdge != nullptr) {
+                _onEdge();
+            }
+        }
+    }
+    // Takes a sample when SAMPLE_MS have passed and queues the events. Returns the milliseconds until
+    // it has to run again or 0 when it waits for the next edge.
+    static uint32_t update() {
+        uint32_t now = SysTickMs::getTicks();
+        if(_sampling && now - _lastSample < SAMPLE_MS) {
+            // an edge between two samples does not count as a sample
+            return SAMPLE_MS - (now - _lastSample);
+        }
+        _edge = false;
+        _lastSample = now;
+        uint32_t levels = sample();
+        _debounce.update(levels);
+        uint32_t held = _debounce.getHeld();
+        uint32_t next = 0;
+        for(uint8_t i = 0; i < COUNT; i++) {
+            uint32_t mask = PIN_MASKS[i];
+            if((_debounce.getPressed() & mask) != 0) {
+                _pressTime[i] = now;
+                _nextRepeat[i] = now + REPEAT_DELAY_MS;
+                _longReported &= ~mask;
+                push(i, ButtonEventType::press);
+            } else if((_debounce.getReleased() & mask) != 0) {
+                push(i, ButtonEventType::release);
+            }
+            if((held & mask) == 0) {
+                continue;
+            }
+            if((_longReported & mask) == 0) {
+                uint32_t heldMs = now - _pressTime[i];
+                if(heldMs >= LONG_PRESS_MS) {
+                    _longReported |= mask;
+                    push(i, ButtonEventType::longPress);
+                } else {
+                    wakeIn(next, LONG_PRESS_MS - heldMs);
+                }
+            }
+            if((_repeat & mask) != 0) {
+                wakeIn(next, repeat(i, now));
+            }
+        }
+        // a stable held button needs no samples, its release edge starts them again
+        _sampling = _debounce.getPending(levels) != 0;
+        if(_sampling) {
+            wakeIn(next, SAMPLE_MS);
+        }
+        return next;
+    }
+    static bool takeEvent(ButtonEvent& event) {
+        if(_count == 0) {
+            return false;
+        }
+        event = _queue[_head];
+        _head = (_head + 1) % QUEUE_SIZE;
+        _count--;
+        return true;
+    }
+    // masks of the last sample, bit n is pin n of the port
+    static uint32_t getPressedMask() {
+        return _debounce.getPressed();
+    }
+    static uint32_t getReleasedMask() {
+        return _debounce.getReleased();
+    }
+    static uint32_t getHeldMask() {
+        return _debounce.getHeld();
+    }
+    static bool isPressed(uint8_t button) {
+        return (_debounce.getHeld() & PIN_MASKS[button]) != 0;
+    }
+    // no button held, no counter running and no edge waiting for update()
+    static bool isIdle() {
+        return !_sampling && !_edge && _debounce.getHeld() == 0;
+    }
+    // events lost because the queue was full
+    static uint32_t getDroppedEvents() {
+        return _dropped;
+    }
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+
+// System clock configurations switched at run time, one Rcc type per profile, the first one is used
+// after reset. The register values SysTick and I2C need for every profile are computed at compile time,
+// Rcc sets the flash latency for its clock. SysTick keeps its 1 ms tick and I2C its bus speed.
+template<typename SysTickMs, typename I2cBus, typename... Rccs>
+class ClockProfiles {
+public:
+    static constexpr uint8_t COUNT = sizeof...(Rccs);
+private:
+    struct Profile {
+        bool (*init)();
+        uint32_t ahbClock;
+        uint16_t i2cCr2Config;
+        uint16_t i2cClockConfig;
+    };
+    static constexpr Profile PROFILES[COUNT] = {
+        {Rccs::init, Rccs::getAHBClock(), I2cBus::getCR2Config(Rccs::getAPB1Clock()), I2cBus::getClockConfig(Rccs::getAPB1Clock())}...
+    };
+    static_assert((I2cBus::isClockValid(Rccs::getAPB1Clock()) && ...), "I2C can not run on every profile");
+    static_assert(((SysTickMs::countsPerMs(Rccs::getAHBClock()) * 1000 * 8 == Rccs::getAHBClock()) && ...),
+                  "SysTick needs whole counts per millisecond");
+
+    static inline uint8_t _profile = 0;
+    static inline uint32_t _switches = 0;
+public:
+    // Sets up the current profile, call it after reset and after standby, which returns to HSI
+    static bool init() {
+        return PROFILES[_profile].init();
+    }
+    // Not while an I2C transaction runs, its bus timing would change in the middle.
+    // The old profile is set up again when the new clock does not start.
+    static bool select(uint8_t profile) {
+        if(profile == _profile) {
+            return true;
+        }
+        if(I2cBus::isBusy()) {
+            return false;
+        }
+        uint8_t previous = _profile;
+        if(!PROFILES[profile].init()) {
+            PROFILES[previous].init();
+            return false;
+        }
+        _profile = profile;
+        SysTickMs::setClock(PROFILES[profile].ahbClock);
+        I2cBus::setClock(PROFILES[profile].i2cCr2Config, PROFILES[profile].i2cClockConfig);
+        _switches++;
+        return true;
+    }
+    static uint8_t getProfile() {
+        return _profile;
+    }
+    static uint32_t getAHBClock() {
+        return PROFILES[_profile].ahbClock;
+    }
+    static uint32_t getSwitches() {
+        return _switches;
+    }
+};
@@ -2,8 +2,13 @@
 
 #include "main.hpp"
 
-extern "C" void HardFault_Handler(void) __attribute__((interrupt));
-extern "C" void SysTick_Handler(void) __attribute__((interrupt));
+extern "C" void HardFault_Handler(void) RV_INTERRUPT;
+extern "C" void SysTick_Handler(void) RV_INTERRUPT;
+extern "C" void DMA1_Channel6_IRQHandler(void) RV_INTERRUPT;
+extern "C" void I2C1_EV_IRQHandler(void) RV_INTERRUPT;
+extern "C" void I2C1_ER_IRQHandler(void) RV_INTERRUPT;
+extern "C" void EXTI7_0_IRQHandler(void) RV_INTERRUPT;
+extern "C" void AWU_IRQHandler(void) RV_INTERRUPT;
 
 
 extern "C" void HardFault_Handler(void) {
@@ -13,4 +18,27 @@ extern "C" void HardFault_Handler(void) {
 extern "C" void SysTick_Handler(void) {
     SysTick->SR = 0;
     SysTickMsTimer::incrementTicks();
-}
\ No newline at end of file
+}
+
+extern "C" void DMA1_Channel6_IRQHandler(void) {
+    I2c1::dmaTxIrqHandler();
+}
+
+extern "C" void I2C1_EV_IRQHandler(void) {
+    I2c1::eventIrqHandler();
+}
+
+extern "C" void I2C1_ER_IRQHandler(void) {
+    I2c1::errorIrqHandler();
+}
+
+extern "C" void EXTI7_0_IRQHandler(void) {
+    if(RtcSqwExti::isPending()) {
+        RtcSqwExti::irqHandler();
+    }
+    ButtonInput::irqHandler();
+}
+
+extern "C" void AWU_IRQHandler(void) {
+    Power::awuIrqHandler();
+}
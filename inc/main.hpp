@@ -1,15 +1,27 @@
 #pragma once
 
+#include <type_traits>
+
 #include "rcc_ch32v00x.hpp"
 #include "gpio_ch32v00x.hpp"
+#include "exti_ch32v00x.hpp"
 #include "systick_ch32v00x.hpp"
+#include "pwr_ch32v00x.hpp"
 #include "i2c_ch32v00x.hpp"
+#include "scheduler.hpp"
+#include "buttons.hpp"
+#include "clock_profiles.hpp"
 
 #include "ds3231.hpp"
+#include "ds3231_clock.hpp"
 #include "ssd1306.hpp"
+#include "ssd1306_stream.hpp"
 
 using SysClkHsi = SysClock<SysClockSource::HSI>;
-using RccPllHsi = Rcc<SysClkHsi, AhbPsc::AHB1>;
+using SysClkPllHsi = SysClock<SysClockSource::PLL, Pll<PllSource::HSI>>;
+// 48 MHz while rendering and transferring, 6 MHz while idle. HSI/8 would be below the 4 MHz I2C needs.
+using RccPllHsi = Rcc<SysClkPllHsi, AhbPsc::AHB1>;
+using RccHsiDiv4 = Rcc<SysClkHsi, AhbPsc::AHB4>;
 using SysTickMsTimer = SysTickMs<RccPllHsi>;
 
 using I2c1SDA = Gpio<GpioPort::C, GpioPin::P1, GpioMode::Out50M, GpioCnf::AltOD, GpioPull::Up>;
@@ -17,7 +29,44 @@ using I2c1SCL = Gpio<GpioPort::C, GpioPin::P2, GpioMode::Out50M, GpioCnf::AltOD,
 using InputPin = Gpio<GpioPort::C, GpioPin::P3, GpioMode::In, GpioCnf::Pull, GpioPull::Up>;
 using I2c1Params = I2cParams<I2cInstance::i2c1, I2cSpeed::fast>;
 using I2c1 = I2c<I2c1Params, RccPllHsi, SysTickMsTimer>;
+using Clocks = ClockProfiles<SysTickMsTimer, I2c1, RccPllHsi, RccHsiDiv4>;
+enum ClockProfileId : uint8_t {RUN_CLOCK, IDLE_CLOCK};
+using Power = Pwr<Clocks, SysTickMsTimer>;
 
 using ModeButton = Gpio<GpioPort::C, GpioPin::P0, GpioMode::In, GpioCnf::Pull, GpioPull::Up>;
 using PlusButton = Gpio<GpioPort::C, GpioPin::P3, GpioMode::In, GpioCnf::Pull, GpioPull::Up>;
-using MinusButton = Gpio<GpioPort::C, GpioPin::P4, GpioMode::In, GpioCnf::Pull, GpioPull::Up>;
\ No newline at end of file
+using MinusButton = Gpio<GpioPort::C, GpioPin::P4, GpioMode::In, GpioCnf::Pull, GpioPull::Up>;
+using ButtonInput = Buttons<SysTickMsTimer, ModeButton, PlusButton, MinusButton>;
+enum ButtonId : uint8_t {MODE_BUTTON, PLUS_BUTTON, MINUS_BUTTON};
+
+// Standby between the seconds of the normal screen, a button press, the square wave or the AWU wake it up.
+// Without the square wave the AWU wakes it about 6 times a second and each wake-up reads the chip seconds.
+// The debug interface does not work in standby. The simulator tests build it with -DCLOCK_LOW_POWER_STANDBY=true.
+#ifndef CLOCK_LOW_POWER_STANDBY
+#define CLOCK_LOW_POWER_STANDBY false
+#endif
+static constexpr bool LOW_POWER_STANDBY = CLOCK_LOW_POWER_STANDBY;
+
+// The DS3231 1 Hz square wave aligns the local clock to the chip seconds.
+// The board leaves the INT/SQW pin open, it has to be wired to PC7 before this is enabled. The output is
+// open drain, the internal pull-up of PC7 is enough. The simulator tests build it with -DCLOCK_RTC_SECOND_TICK=true.
+#ifndef CLOCK_RTC_SECOND_TICK
+#define CLOCK_RTC_SECOND_TICK false
+#endif
+static constexpr bool RTC_SECOND_TICK = CLOCK_RTC_SECOND_TICK;
+using RtcSqwPin = Gpio<GpioPort::C, GpioPin::P7, GpioMode::In, GpioCnf::Pull, GpioPull::Up>;
+using RtcSqwExti = Exti<GpioPort::C, GpioPin::P7, ExtiTrigger::falling>;
+
+// Page streaming renders a display list page by page instead of keeping the 1 KB frame buffer in RAM.
+// The frame buffer renderer leaves little of the 2 KB RAM to the stack.
+#ifndef CLOCK_OLED_PAGE_STREAMING
+#define CLOCK_OLED_PAGE_STREAMING true
+#endif
+static constexpr bool OLED_PAGE_STREAMING = CLOCK_OLED_PAGE_STREAMING;
+
+using Rtc = DS3231<I2c1>;
+using RtcClock = DS3231Clock<Rtc, SysTickMsTimer>;
+using Oled = std::conditional_t<OLED_PAGE_STREAMING, SSD1306PageStream<I2c1>, SSD1306<I2c1>>;
+
+// The clock application in src/clock.cpp, it does not return
+void runClock();
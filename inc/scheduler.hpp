@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstdint>
+#include "ch32v00x.h"
+
+struct SchedulerTask {
+    void (*run)();
+    uint16_t periodMs;      // 0 for a task that only runs after trigger()
+    uint16_t deadlineMs;    // allowed delay from the release (period or trigger) to the start
+};
+
+struct SchedulerTaskStats {
+    uint32_t runs;
+    uint32_t misses;        // starts later than the deadline
+    uint32_t worstUs;       // longest run
+    uint16_t worstLatencyMs;
+};
+
+// Cooperative scheduler over a fixed task table. Every pass runs the due tasks in table order,
+// then sleeps until the next periodic release or an interrupt. Idle::idle(ms) does the sleeping,
+// an application policy can replace the SysTick sleep by a deeper one there. It is called with
+// interrupts disabled, has to wake on a pending interrupt and enables interrupts on return.
+template<typename SysTickMs, uint8_t COUNT, typename Idle = SysTickMs>
+class Scheduler {
+public:
+    constexpr Scheduler(const SchedulerTask (&tasks)[COUNT])
+        : _tasks(tasks) {}
+
+    // Releases the task on the next pass, may be called from interrupts
+    void trigger(uint8_t task) {
+        if(!_triggered[task]) {
+            _triggerTime[task] = SysTickMs::getTicks();
+            _triggered[task] = true;
+        }
+    }
+    [[noreturn]] void run() {
+        restart();
+        for(;;) {
+            runOnce();
+        }
+    }
+    // Releases a task without period after ms, from the main loop only. A timer for tasks that
+    // only have work while something is going on, e.g. a debounce time.
+    void triggerAfter(uint8_t task, uint32_t ms) {
+        _release[task] = SysTickMs::getTicks() + ms;
+        _delayed[task] = true;
+    }
+    // Lets every periodic task start from now, after a sleep that skipped its releases on purpose
+    void restart() {
+        uint32_t now = SysTickMs::getTicks();
+        for(uint8_t i = 0; i < COUNT; i++) {
+            _release[i] = now;
+        }
+    }
+    void runOnce() {
+        for(uint8_t i = 0; i < COUNT; i++) {
+            uint32_t now = SysTickMs::getTicks();
+            uint32_t release;
+            if(_triggered[i]) {
+                _triggered[i] = false;
+                release = _triggerTime[i];
+            } else if(isTimed(i) && static_cast<int32_t>(now - _release[i]) >= 0) {
+                release = _release[i];
+                if(_tasks[i].periodMs == 0) {
+                    _delayed[i] = false;
+                } else {
+                    _release[i] += _tasks[i].periodMs;
+                    // after an overrun the missed releases are dropped, not run back to back
+                    if(static_cast<int32_t>(now - _release[i]) >= 0) {
+                        _release[i] = now + _tasks[i].periodMs;
+                    }
+                }
+            } else {
+                continue;
+            }
+            execute(i, now - release);
+        }
+        sleep();
+    }
+    const SchedulerTaskStats& getStats(uint8_t task) {
+        return _stats[task];
+    }
+    // worst execution time in microseconds
+    uint32_t getWorstCaseUs(uint8_t task) {
+        return _stats[task].worstUs;
+    }
+private:
+    const SchedulerTask (&_tasks)[COUNT];
+    uint32_t _release[COUNT] = {};
+    volatile uint32_t _triggerTime[COUNT] = {};
+    volatile bool _triggered[COUNT] = {};
+    bool _delayed[COUNT] = {};
+    SchedulerTaskStats _stats[COUNT] = {};
+
+    bool isTimed(uint8_t task) {
+        return _tasks[task].periodMs != 0 || _delayed[task];
+    }
+
+    void execute(uint8_t task, uint32_t latency) {
+        SchedulerTaskStats& stats = _stats[task];
+        if(latency > _tasks[task].deadlineMs) {
+            stats.misses++;
+        }
+        if(latency > stats.worstLatencyMs) {
+            stats.worstLatencyMs = latency > 0xFFFF ? 0xFFFF : latency;
+        }
+        uint32_t start = SysTickMs::getMicros();
+        _tasks[task].run();
+        uint32_t us = SysTickMs::getMicros() - start;
+        if(us > stats.worstUs) {
+            stats.worstUs = us;
+        }
+        stats.runs++;
+    }
+    // The check for work and the sleep are one section with interrupts disabled: an interrupt that
+    // triggers a task after the check stays pending and ends the sleep right away.
+    void sleep() {
+        __disable_irq();
+        uint32_t now = SysTickMs::getTicks();
+        uint32_t wait = UINT32_MAX;
+        for(uint8_t i = 0; i < COUNT; i++) {
+            if(_triggered[i]) {
+                __enable_irq();
+                return;
+            }
+            if(!isTimed(i)) {
+                continue;
+            }
+            int32_t remaining = static_cast<int32_t>(_release[i] - now);
+            if(remaining <= 0) {
+                __enable_irq();
+                return;
+            }
+            if(static_cast<uint32_t>(remaining) < wait) {
+                wait = remaining;
+            }
+        }
+        Idle::idle(wait);
+    }
+};
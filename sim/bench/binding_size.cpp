@@ -0,0 +1,26 @@
+// The drivers and the bus code a clock needs, bound to the I2c class or with BINDING_ADAPTER to the
+// I2CInterface table. Only compiled, the binding_size target prints the section sizes of both.
+
+#include "main.hpp"
+
+#ifdef BINDING_ADAPTER
+using Bus = I2cInterfaceAdapter;
+#else
+using Bus = I2c1;
+#endif
+
+DS3231<Bus> rtc(0x68 << 1);
+uint8_t buffer[SSD1306<Bus>::BUFFER_SIZE];
+SSD1306<Bus> display(0x3C << 1, buffer);
+
+void exercise() {
+#ifdef BINDING_ADAPTER
+    I2cInterfaceAdapter::instance = I2c1::getInterface();
+#endif
+    rtc.init();
+    rtc.readData();
+    rtc.setTime(rtc.getTime());
+    rtc.flush();
+    display.init();
+    display.updateScreen();
+}
@@ -0,0 +1,116 @@
+// Host cost of the drawing primitives against the drawPixel loops they replaced, built with -O2.
+// Host nanoseconds only rank the variants, the CH32V003 has no cache and a slower memory bus.
+// ./build/sim/draw_bench
+
+#include <chrono>
+#include <cstdio>
+
+#include "main.hpp"
+#include "../tests/sim_test.hpp"
+
+namespace {
+
+using Display = SSD1306<I2c1>;
+
+constexpr auto& font8x8 = sim_test::DIGITS;
+constexpr auto columns8x8 = transposeFont8x8(font8x8);
+constexpr auto font16x16 = scaleFont16x16(font8x8);
+
+uint8_t buffer[Display::BUFFER_SIZE];
+Display display(0x3C << 1, buffer);
+
+constexpr uint32_t RUNS = 200000;
+
+// nanoseconds per call of draw(i)
+template<typename Draw>
+double measure(Draw draw) {
+    auto start = std::chrono::steady_clock::now();
+    for(uint32_t i = 0; i < RUNS; i++) {
+        draw(i);
+    }
+    std::chrono::duration<double, std::nano> time = std::chrono::steady_clock::now() - start;
+    // keeps the drawing from being optimised away
+    volatile uint8_t sink = buffer[RUNS % Display::BUFFER_SIZE];
+    (void)sink;
+    return time.count() / RUNS;
+}
+
+void print(const char* name, double before, double after) {
+    std::printf("%-24s %8.1f ns %8.1f ns %6.1fx\n", name, before, after, before / after);
+}
+
+void drawPixels16x16(uint8_t x, uint8_t y, const uint8_t (&rows)[8]) {
+    for(uint8_t i = 0; i < 8; i++) {
+        for(uint8_t j = 0; j < 8; j++) {
+            bool lit = rows[i] & (1 << (7 - j));
+            display.drawPixel(x + 2 * j, y + 2 * i, lit);
+            display.drawPixel(x + 2 * j + 1, y + 2 * i, lit);
+            display.drawPixel(x + 2 * j, y + 2 * i + 1, lit);
+            display.drawPixel(x + 2 * j + 1, y + 2 * i + 1, lit);
+        }
+    }
+}
+
+void drawPixels8x8(uint8_t x, uint8_t y, const uint8_t (&rows)[8]) {
+    for(uint8_t i = 0; i < 8; i++) {
+        for(uint8_t j = 0; j < 8; j++) {
+            display.drawPixel(x + j, y + i, rows[i] & (1 << (7 - j)));
+        }
+    }
+}
+
+// showCursor before the rect primitives
+void invertPixels(uint8_t x, uint8_t y, uint8_t width, uint8_t height) {
+    for(uint8_t i = x; i < x + width; i++) {
+        for(uint8_t j = y; j < y + height; j++) {
+            display.invertPixel(i, j);
+        }
+    }
+}
+
+// a font with all printable ASCII characters
+struct Printable {
+    char chars[96] = {};
+
+    constexpr Printable() {
+        for(uint8_t i = 0; i < 95; i++) {
+            chars[i] = static_cast<char>(' ' + i);
+        }
+    }
+};
+constexpr Printable PRINTABLE;
+constexpr SSD1306CharMap asciiMap = makeCharMap(PRINTABLE.chars, 0);
+
+// getIndexOfChar before the table
+uint8_t searchIndex(char c) {
+    for(uint8_t i = 0; i < 95; i++) {
+        if(PRINTABLE.chars[i] == c) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+} // namespace
+
+int main() {
+    std::printf("%-24s %11s %11s %7s\n", "per call", "before", "after", "");
+    print("16x16 digit, y = 40", measure([](uint32_t i) { drawPixels16x16(10, 40, font8x8[i % 10]); }),
+          measure([](uint32_t i) { display.drawGlyph(10, 40, font16x16[i % 10]); }));
+    print("8x8 digit, y = 8", measure([](uint32_t i) { drawPixels8x8(14, 8, font8x8[i % 10]); }),
+          measure([](uint32_t i) { display.drawGlyph(14, 8, columns8x8[i % 10]); }));
+    print("8x8 digit, y = 10", measure([](uint32_t i) { drawPixels8x8(14, 10, font8x8[i % 10]); }),
+          measure([](uint32_t i) { display.drawGlyph(14, 10, columns8x8[i % 10]); }));
+    print("31x17 cursor, invert", measure([](uint32_t) { invertPixels(10, 39, 31, 17); }),
+          measure([](uint32_t) { display.invertRect(10, 39, 31, 17); }));
+    // the character comes from a volatile read, so neither lookup is folded
+    static volatile char text[95];
+    for(uint8_t i = 0; i < 95; i++) {
+        text[i] = PRINTABLE.chars[i];
+    }
+    print("glyph index, ASCII font", measure([](uint32_t i) { buffer[i % 64] = searchIndex(text[i % 95]); }),
+          measure([](uint32_t i) { buffer[i % 64] = asciiMap[text[i % 95]]; }));
+    std::printf("16x16 table: %u bytes of flash for 10 digits, the 8x8 source font %u bytes\n",
+                static_cast<unsigned>(sizeof(font16x16)), static_cast<unsigned>(sizeof(font8x8)));
+    return 0;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+// Host build of the device header: the register bit definitions come from the vendor header,
+// the register blocks are simulator objects with the same member names.
+
+#define RCC_TypeDef             CH32_RCC_TypeDef
+#define FLASH_TypeDef           CH32_FLASH_TypeDef
+#define GPIO_TypeDef            CH32_GPIO_TypeDef
+#define AFIO_TypeDef            CH32_AFIO_TypeDef
+#define EXTI_TypeDef            CH32_EXTI_TypeDef
+#define PWR_TypeDef             CH32_PWR_TypeDef
+#define DMA_TypeDef             CH32_DMA_TypeDef
+#define DMA_Channel_TypeDef     CH32_DMA_Channel_TypeDef
+#define I2C_TypeDef             CH32_I2C_TypeDef
+#include "../../inc/ch32v00x.h"
+#undef RCC_TypeDef
+#undef FLASH_TypeDef
+#undef GPIO_TypeDef
+#undef AFIO_TypeDef
+#undef EXTI_TypeDef
+#undef PWR_TypeDef
+#undef DMA_TypeDef
+#undef DMA_Channel_TypeDef
+#undef I2C_TypeDef
+
+#include "sim_registers.hpp"
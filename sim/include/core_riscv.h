@@ -0,0 +1,56 @@
+#pragma once
+
+// Host replacement of the core header: the same types and intrinsics, backed by the simulator.
+// PFIC and SysTick are defined in sim_registers.hpp together with the other peripherals.
+
+#include <stdint.h>
+
+#define     __I     volatile const
+#define     __O     volatile
+#define     __IO    volatile
+
+typedef __I uint32_t vuc32;
+typedef __I uint16_t vuc16;
+typedef __I uint8_t vuc8;
+typedef const uint32_t uc32;
+typedef const uint16_t uc16;
+typedef const uint8_t uc8;
+typedef __I int32_t vsc32;
+typedef __I int16_t vsc16;
+typedef __I int8_t vsc8;
+typedef const int32_t sc32;
+typedef const int16_t sc16;
+typedef const int8_t sc8;
+typedef __IO uint32_t  vu32;
+typedef __IO uint16_t vu16;
+typedef __IO uint8_t  vu8;
+typedef uint32_t  u32;
+typedef uint16_t u16;
+typedef uint8_t  u8;
+typedef __IO int32_t  vs32;
+typedef __IO int16_t  vs16;
+typedef __IO int8_t   vs8;
+typedef int32_t  s32;
+typedef int16_t s16;
+typedef int8_t  s8;
+
+typedef enum {NoREADY = 0, READY = !NoREADY} ErrorStatus;
+typedef enum {DISABLE = 0, ENABLE = !DISABLE} FunctionalState;
+typedef enum {RESET = 0, SET = !RESET} FlagStatus, ITStatus;
+
+#define   RV_STATIC_INLINE  static  inline
+// the interrupt model calls the handlers as ordinary functions
+#define   RV_INTERRUPT
+
+void __enable_irq(void);
+void __disable_irq(void);
+uint32_t __get_MSTATUS(void);
+void __set_MSTATUS(uint32_t value);
+void __NOP(void);
+void __WFI(void);
+void __WFE(void);
+void NVIC_EnableIRQ(IRQn_Type IRQn);
+void NVIC_DisableIRQ(IRQn_Type IRQn);
+uint32_t NVIC_GetStatusIRQ(IRQn_Type IRQn);
+void NVIC_SetPriority(IRQn_Type IRQn, uint8_t priority);
+void NVIC_SystemReset(void);
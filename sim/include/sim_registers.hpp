@@ -0,0 +1,154 @@
+#pragma once
+
+#include <cstdint>
+
+namespace sim {
+
+// Behaviour behind a register block. Without a model a register is plain storage.
+class Peripheral {
+public:
+    virtual uint32_t read(const void* reg) = 0;
+    virtual void write(const void* reg, uint32_t value) = 0;
+protected:
+    ~Peripheral() = default;
+};
+
+struct Registers {
+    Peripheral* model = nullptr;
+};
+
+// Every access costs bus time, so the events due until then happen first.
+// Pending interrupts are taken after the access, like after the load or store instruction.
+void beginAccess();
+void endAccess();
+
+template<typename T>
+class Reg {
+public:
+    explicit Reg(Registers& owner) : _owner(owner) {}
+    Reg(const Reg&) = delete;
+
+    operator T() {
+        beginAccess();
+        T value = _owner.model != nullptr ? static_cast<T>(_owner.model->read(this)) : _value;
+        endAccess();
+        return value;
+    }
+    Reg& operator=(T value) {
+        beginAccess();
+        if(_owner.model != nullptr) {
+            _owner.model->write(this, value);
+        } else {
+            _value = value;
+        }
+        endAccess();
+        return *this;
+    }
+    Reg& operator=(const Reg& other) = delete;
+    // read-modify-write, two accesses like on the chip
+    Reg& operator|=(uint32_t value) { return *this = static_cast<T>(static_cast<T>(*this) | value); }
+    Reg& operator&=(uint32_t value) { return *this = static_cast<T>(static_cast<T>(*this) & value); }
+    Reg& operator^=(uint32_t value) { return *this = static_cast<T>(static_cast<T>(*this) ^ value); }
+
+    // storage access for the models, no bus time and no side effects
+    T peek() const { return _value; }
+    void poke(T value) { _value = value; }
+private:
+    Registers& _owner;
+    T _value = 0;
+};
+
+} // namespace sim
+
+using SimReg32 = sim::Reg<uint32_t>;
+using SimReg16 = sim::Reg<uint16_t>;
+
+struct RCC_TypeDef : sim::Registers {
+    SimReg32 CTLR{*this}, CFGR0{*this}, INTR{*this}, APB2PRSTR{*this}, APB1PRSTR{*this};
+    SimReg32 AHBPCENR{*this}, APB2PCENR{*this}, APB1PCENR{*this}, RSTSCKR{*this};
+};
+struct FLASH_TypeDef : sim::Registers {
+    SimReg32 ACTLR{*this}, KEYR{*this}, OBKEYR{*this}, STATR{*this}, CTLR{*this}, ADDR{*this};
+    SimReg32 OBR{*this}, WPR{*this}, MODEKEYR{*this}, BOOT_MODEKEYR{*this};
+};
+struct GPIO_TypeDef : sim::Registers {
+    SimReg32 CFGLR{*this}, INDR{*this}, OUTDR{*this}, BSHR{*this}, BCR{*this}, LCKR{*this};
+};
+struct AFIO_TypeDef : sim::Registers {
+    SimReg32 PCFR1{*this}, EXTICR{*this};
+};
+struct EXTI_TypeDef : sim::Registers {
+    SimReg32 INTENR{*this}, EVENR{*this}, RTENR{*this}, FTENR{*this}, SWIEVR{*this}, INTFR{*this};
+};
+struct PWR_TypeDef : sim::Registers {
+    SimReg32 CTLR{*this}, CSR{*this}, AWUCSR{*this}, AWUWR{*this}, AWUPSC{*this};
+};
+struct DMA_TypeDef : sim::Registers {
+    SimReg32 INTFR{*this}, INTFCR{*this};
+};
+struct DMA_Channel_TypeDef : sim::Registers {
+    SimReg32 CFGR{*this}, CNTR{*this}, PADDR{*this}, MADDR{*this};
+};
+struct I2C_TypeDef : sim::Registers {
+    SimReg16 CTLR1{*this}, CTLR2{*this}, OADDR1{*this}, OADDR2{*this}, DATAR{*this};
+    SimReg16 STAR1{*this}, STAR2{*this}, CKCFGR{*this}, RTR{*this};
+};
+struct PFIC_Type : sim::Registers {
+    SimReg32 SCTLR{*this};
+};
+struct SysTick_Type : sim::Registers {
+    SimReg32 CTLR{*this}, SR{*this}, CNT{*this}, CMP{*this};
+};
+
+namespace sim {
+extern RCC_TypeDef rcc;
+extern FLASH_TypeDef flash;
+extern GPIO_TypeDef gpioA, gpioC, gpioD;
+extern AFIO_TypeDef afio;
+extern EXTI_TypeDef exti;
+extern PWR_TypeDef pwr;
+extern DMA_TypeDef dma1;
+extern DMA_Channel_TypeDef dma1Channels[7];
+extern I2C_TypeDef i2c1;
+extern PFIC_Type pfic;
+extern SysTick_Type sysTick;
+} // namespace sim
+
+#undef RCC
+#undef FLASH
+#undef GPIOA
+#undef GPIOC
+#undef GPIOD
+#undef AFIO
+#undef EXTI
+#undef PWR
+#undef DMA1
+#undef DMA1_Channel1
+#undef DMA1_Channel2
+#undef DMA1_Channel3
+#undef DMA1_Channel4
+#undef DMA1_Channel5
+#undef DMA1_Channel6
+#undef DMA1_Channel7
+#undef I2C1
+
+#define RCC             (&sim::rcc)
+#define FLASH           (&sim::flash)
+#define GPIOA           (&sim::gpioA)
+#define GPIOC           (&sim::gpioC)
+#define GPIOD           (&sim::gpioD)
+#define AFIO            (&sim::afio)
+#define EXTI            (&sim::exti)
+#define PWR             (&sim::pwr)
+#define DMA1            (&sim::dma1)
+#define DMA1_Channel1   (&sim::dma1Channels[0])
+#define DMA1_Channel2   (&sim::dma1Channels[1])
+#define DMA1_Channel3   (&sim::dma1Channels[2])
+#define DMA1_Channel4   (&sim::dma1Channels[3])
+#define DMA1_Channel5   (&sim::dma1Channels[4])
+#define DMA1_Channel6   (&sim::dma1Channels[5])
+#define DMA1_Channel7   (&sim::dma1Channels[6])
+#define I2C1            (&sim::i2c1)
+#define PFIC            (&sim::pfic)
+#define NVIC            PFIC
+#define SysTick         (&sim::sysTick)
@@ -0,0 +1,161 @@
+#include "ds3231_model.hpp"
+
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+uint8_t toBcd(uint8_t value) {
+    return static_cast<uint8_t>(((value / 10) << 4) | (value % 10));
+}
+
+uint8_t fromBcd(uint8_t value) {
+    return static_cast<uint8_t>((value >> 4) * 10 + (value & 0x0F));
+}
+
+uint8_t getDaysInMonth(uint8_t month, uint8_t year) {
+    static constexpr uint8_t DAYS[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if(month == 2 && year % 4 == 0) {
+        return 29;
+    }
+    return DAYS[(month - 1) % 12];
+}
+
+// register masks, bits outside of them read as 0
+constexpr uint8_t WRITABLE[Ds3231Model::REGISTER_COUNT] = {
+    0x7F, 0x7F, 0x3F, 0x07, 0x3F, 0x9F, 0xFF,   // time and calendar, 24 hour mode
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,   // alarms
+    0xFF, 0x8B, 0xFF, 0x00, 0x00                // control, status, aging, temperature
+};
+
+} // namespace
+
+Ds3231Model::Ds3231Model(sim::Port sqwPort, uint8_t sqwPin)
+    : _sqwPort(sqwPort), _sqwPin(sqwPin) {
+    // power-on state: oscillator and square wave on at 1 Hz interrupt mode, 01.01.2000 00:00:00
+    _regs[0x03] = 0x01;
+    _regs[0x04] = 0x01;
+    _regs[0x05] = 0x01;
+    _regs[CONTROL] = 0x1C;
+    setTemperature(25.0f);
+    sim::addTimed(*this);
+    sim::attachI2c(*this);
+}
+
+void Ds3231Model::setDateTime(const DateTime& dateTime) {
+    _regs[0x00] = toBcd(dateTime.seconds % 60);
+    _regs[0x01] = toBcd(dateTime.minutes % 60);
+    _regs[0x02] = toBcd(dateTime.hours % 24);
+    _regs[0x04] = toBcd(dateTime.date);
+    _regs[0x05] = toBcd(dateTime.month);
+    _regs[0x06] = toBcd(dateTime.year % 100);
+    _secondStart = sim::now();
+}
+
+Ds3231Model::DateTime Ds3231Model::getDateTime() const {
+    return {fromBcd(_regs[0x06]), fromBcd(_regs[0x05] & 0x1F), fromBcd(_regs[0x04]),
+            fromBcd(_regs[0x02]), fromBcd(_regs[0x01]), fromBcd(_regs[0x00])};
+}
+
+void Ds3231Model::setTemperature(float celsius) {
+    int quarters = static_cast<int>(std::lround(celsius * 4));
+    _regs[TEMPERATURE_MSB] = static_cast<uint8_t>(static_cast<int8_t>(quarters >> 2));
+    _regs[TEMPERATURE_LSB] = static_cast<uint8_t>((quarters & 0x03) << 6);
+}
+
+bool Ds3231Model::start(bool read) {
+    _expectPointer = !read;
+    std::memcpy(_latched, _regs, TIME_REGISTERS);
+    return true;
+}
+
+bool Ds3231Model::write(uint8_t byte) {
+    if(_expectPointer) {
+        _expectPointer = false;
+        _pointer = byte % REGISTER_COUNT;
+        return true;
+    }
+    writeRegister(_pointer, byte);
+    _pointer = (_pointer + 1) % REGISTER_COUNT;
+    return true;
+}
+
+uint8_t Ds3231Model::read() {
+    uint8_t value = _pointer < TIME_REGISTERS ? _latched[_pointer] : _regs[_pointer];
+    _pointer = (_pointer + 1) % REGISTER_COUNT;
+    return value;
+}
+
+void Ds3231Model::stop() {
+    _expectPointer = false;
+}
+
+void Ds3231Model::writeRegister(uint8_t reg, uint8_t value) {
+    value &= WRITABLE[reg];
+    if(reg == STATUS) {
+        // OSF and the alarm flags can only be cleared
+        value = (value & 0x08) | (_regs[STATUS] & value & 0x83);
+    }
+    _regs[reg] = value;
+    if(reg == 0x00) {
+        _secondStart = sim::now();
+        _sqwLow = false;
+    }
+    updateSquareWave();
+}
+
+uint64_t Ds3231Model::nextEvent() {
+    return _secondStart + (_sqwLow ? sim::UNITS_PER_SECOND / 2 : sim::UNITS_PER_SECOND);
+}
+
+void Ds3231Model::process(uint64_t time) {
+    while(time >= nextEvent()) {
+        if(_sqwLow) {
+            _sqwLow = false;
+        } else {
+            _secondStart += sim::UNITS_PER_SECOND;
+            _sqwLow = true;
+            tick();
+        }
+        updateSquareWave();
+    }
+}
+
+void Ds3231Model::tick() {
+    DateTime now = getDateTime();
+    uint8_t century = _regs[0x05] & 0x80;
+    if(++now.seconds < 60) {
+        _regs[0x00] = toBcd(now.seconds);
+        return;
+    }
+    _regs[0x00] = 0;
+    if(++now.minutes < 60) {
+        _regs[0x01] = toBcd(now.minutes);
+        return;
+    }
+    _regs[0x01] = 0;
+    if(++now.hours < 24) {
+        _regs[0x02] = toBcd(now.hours);
+        return;
+    }
+    _regs[0x02] = 0;
+    _regs[0x03] = static_cast<uint8_t>(_regs[0x03] % 7 + 1);
+    if(++now.date <= getDaysInMonth(now.month, now.year)) {
+        _regs[0x04] = toBcd(now.date);
+        return;
+    }
+    _regs[0x04] = 0x01;
+    if(++now.month <= 12) {
+        _regs[0x05] = static_cast<uint8_t>(century | toBcd(now.month));
+        return;
+    }
+    now.year = (now.year + 1) % 100;
+    _regs[0x05] = static_cast<uint8_t>((now.year == 0 ? (century ^ 0x80) : century) | 0x01);
+    _regs[0x06] = toBcd(now.year);
+}
+
+// open drain output, only the 1 Hz rate is modelled
+void Ds3231Model::updateSquareWave() {
+    bool enabled = !(_regs[CONTROL] & CONTROL_INTCN) && (_regs[CONTROL] & CONTROL_RS) == 0;
+    sim::drivePin(_sqwPort, _sqwPin, enabled && _sqwLow);
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+
+#include "mcu.hpp"
+
+// DS3231 register file with its own time base: the calendar counts in BCD once per second,
+// the time registers are copied at START so a read is consistent, writing the seconds restarts
+// the second. With INTCN = 0 the 1 Hz square wave pulls INT/SQW (PC7) low at every seconds update.
+// 24 hour mode only, the alarms are not counted.
+class Ds3231Model : public sim::I2cDevice, public sim::Timed {
+public:
+    static constexpr uint8_t ADDRESS = 0x68;
+    static constexpr uint8_t REGISTER_COUNT = 0x13;
+
+    struct DateTime {
+        uint8_t year;   // 0..99, 20xx
+        uint8_t month;
+        uint8_t date;
+        uint8_t hours;
+        uint8_t minutes;
+        uint8_t seconds;
+    };
+
+    Ds3231Model(sim::Port sqwPort, uint8_t sqwPin);
+
+    void setDateTime(const DateTime& dateTime);
+    DateTime getDateTime() const;
+    // degrees in steps of 0.25
+    void setTemperature(float celsius);
+    uint8_t getRegister(uint8_t reg) const {
+        return _regs[reg];
+    }
+    // sets status bits as the chip does, OSF after a power loss or A1F/A2F at an alarm
+    void setStatusFlags(uint8_t flags) {
+        _regs[STATUS] |= flags & (STATUS_OSF | 0x03);
+    }
+
+    uint8_t getAddress() const override {
+        return ADDRESS;
+    }
+    bool start(bool read) override;
+    bool write(uint8_t byte) override;
+    uint8_t read() override;
+    void stop() override;
+
+    uint64_t nextEvent() override;
+    void process(uint64_t time) override;
+private:
+    static constexpr uint8_t TIME_REGISTERS = 7;
+    static constexpr uint8_t CONTROL = 0x0E;
+    static constexpr uint8_t STATUS = 0x0F;
+    static constexpr uint8_t TEMPERATURE_MSB = 0x11;
+    static constexpr uint8_t TEMPERATURE_LSB = 0x12;
+    static constexpr uint8_t CONTROL_INTCN = 0x04;
+    static constexpr uint8_t CONTROL_RS = 0x18;
+    static constexpr uint8_t STATUS_OSF = 0x80;
+
+    sim::Port _sqwPort;
+    uint8_t _sqwPin;
+    uint8_t _regs[REGISTER_COUNT] = {};
+    uint8_t _latched[TIME_REGISTERS] = {};
+    uint8_t _pointer = 0;
+    bool _expectPointer = false;
+    uint64_t _secondStart = 0;
+    bool _sqwLow = false;
+
+    void writeRegister(uint8_t reg, uint8_t value);
+    void tick();
+    void updateSquareWave();
+};
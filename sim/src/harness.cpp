@@ -0,0 +1,85 @@
+#include "harness.hpp"
+
+#include <sys/mman.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+
+namespace sim {
+
+namespace {
+
+constexpr size_t FIRMWARE_STACK_SIZE = 1 << 20;
+constexpr uint32_t WATCHDOG_SECONDS = 5;
+
+bool isLow(const void* address) {
+    return (reinterpret_cast<uintptr_t>(address) >> 32) == 0;
+}
+
+void* firmwareThread(void* entry) {
+    runFirmware(reinterpret_cast<void (*)()>(entry));
+    return nullptr;
+}
+
+} // namespace
+
+void PinScript::add(uint64_t time, Port port, uint8_t pin, bool low) {
+    _changes.push_back({time, port, pin, low});
+    std::stable_sort(_changes.begin() + _next, _changes.end(),
+                     [](const Change& a, const Change& b) { return a.time < b.time; });
+    if(!_added) {
+        _added = true;
+        addTimed(*this);
+    }
+}
+
+uint64_t PinScript::nextEvent() {
+    return _next < _changes.size() ? _changes[_next].time : NEVER;
+}
+
+void PinScript::process(uint64_t time) {
+    while(_next < _changes.size() && _changes[_next].time <= time) {
+        drivePin(_changes[_next].port, _changes[_next].pin, _changes[_next].low);
+        _next++;
+    }
+}
+
+int runFirmwareThread(void (*entry)()) {
+    // the firmware hands 32 bit addresses to the DMA, its data and stack have to be below 4 GB
+    static int probe;
+    if(!isLow(&probe)) {
+        std::fprintf(stderr, "sim: static data above 4 GB, build without PIE\n");
+        return 1;
+    }
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK;
+#ifdef MAP_32BIT
+    flags |= MAP_32BIT;
+#endif
+    void* stack = mmap(nullptr, FIRMWARE_STACK_SIZE, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if(stack == MAP_FAILED || !isLow(static_cast<char*>(stack) + FIRMWARE_STACK_SIZE - 1)) {
+        std::fprintf(stderr, "sim: no stack below 4 GB for the firmware\n");
+        return 1;
+    }
+    pthread_attr_t attributes;
+    pthread_attr_init(&attributes);
+    pthread_attr_setstack(&attributes, stack, FIRMWARE_STACK_SIZE);
+    pthread_t thread;
+    if(pthread_create(&thread, &attributes, firmwareThread, reinterpret_cast<void*>(entry)) != 0) {
+        std::fprintf(stderr, "sim: can not start the firmware thread\n");
+        return 1;
+    }
+    // the firmware thread ends the process; a busy loop without register accesses never would
+    uint64_t accesses = getAccessCount();
+    for(uint32_t idle = 0; idle < WATCHDOG_SECONDS;) {
+        sleep(1);
+        uint64_t current = getAccessCount();
+        idle = (current == accesses) ? idle + 1 : 0;
+        accesses = current;
+    }
+    std::fprintf(stderr, "sim: firmware made no register access for %u s, stuck in a busy loop?\n", WATCHDOG_SECONDS);
+    return 2;
+}
+
+} // namespace sim
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "mcu.hpp"
+
+// Shared by the simulator and the tests: scripted pin input and the firmware thread.
+namespace sim {
+
+// Pin levels driven from outside at given virtual times, button contacts for example
+class PinScript : public Timed {
+public:
+    // low pulls the pin down, the changes of one time keep the order they were added in
+    void add(uint64_t time, Port port, uint8_t pin, bool low);
+
+    uint64_t nextEvent() override;
+    void process(uint64_t time) override;
+private:
+    struct Change {
+        uint64_t time;
+        Port port;
+        uint8_t pin;
+        bool low;
+    };
+    std::vector<Change> _changes;
+    size_t _next = 0;
+    bool _added = false;
+};
+
+// Runs entry on a thread whose stack is below 4 GB, as the DMA model needs, and watches it:
+// a thread that makes no register access for a few seconds is stuck in a busy loop.
+// The run ends through setEnd(), the return value is the exit code of a failed start or a stuck run.
+int runFirmwareThread(void (*entry)());
+
+} // namespace sim
@@ -0,0 +1,1156 @@
+#include "mcu.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "ch32v00x.h"
+
+// Empty defaults, the firmware defines the handlers it uses. Programs that drive the models
+// without the firmware link without them.
+extern "C" {
+__attribute__((weak)) void SysTick_Handler(void) {}
+__attribute__((weak)) void EXTI7_0_IRQHandler(void) {}
+__attribute__((weak)) void AWU_IRQHandler(void) {}
+__attribute__((weak)) void DMA1_Channel6_IRQHandler(void) {}
+__attribute__((weak)) void I2C1_EV_IRQHandler(void) {}
+__attribute__((weak)) void I2C1_ER_IRQHandler(void) {}
+}
+
+namespace sim {
+
+RCC_TypeDef rcc;
+FLASH_TypeDef flash;
+GPIO_TypeDef gpioA, gpioC, gpioD;
+AFIO_TypeDef afio;
+EXTI_TypeDef exti;
+PWR_TypeDef pwr;
+DMA_TypeDef dma1;
+DMA_Channel_TypeDef dma1Channels[7];
+I2C_TypeDef i2c1;
+PFIC_Type pfic;
+SysTick_Type sysTick;
+
+namespace {
+
+// a register access together with the instructions around it
+constexpr uint64_t ACCESS_CYCLES = 8;
+constexpr uint32_t HSI_CLOCK = 24000000;
+constexpr uint32_t HSE_CLOCK = 24000000;
+constexpr uint32_t LSI_CLOCK = 128000;
+constexpr uint32_t SLEEPDEEP = 0x00000004;
+constexpr uint32_t AWUEN = 0x00000002;
+constexpr uint8_t AWU_LINE = 9;
+constexpr uint8_t I2C_DMA_CHANNEL = 6;
+
+uint64_t _now = 0;
+uint64_t _end = NEVER;
+std::function<void()> _onEnd;
+bool _finishing = false;
+bool _mie = true;
+bool _inHandler = false;
+bool _standby = false;
+uint64_t _enabledIrqs = 0;
+uint64_t _cycleUnits = UNITS_PER_SECOND / HSI_CLOCK;
+uint64_t _sleepUnits = 0;
+uint64_t _standbyUnits = 0;
+uint32_t _interrupts = 0;
+uint32_t _clockSwitches = 0;
+std::atomic<uint64_t> _accesses{0};
+std::vector<Timed*> _timed;
+
+void finish() {
+    if(_finishing) {
+        return;
+    }
+    _finishing = true;
+    if(_onEnd) {
+        _onEnd();
+    }
+    std::exit(0);
+}
+
+uint64_t nextEventTime() {
+    uint64_t next = NEVER;
+    for(Timed* timed : _timed) {
+        next = std::min(next, timed->nextEvent());
+    }
+    return next;
+}
+
+void processDue() {
+    bool any;
+    do {
+        any = false;
+        for(Timed* timed : _timed) {
+            if(timed->nextEvent() <= _now) {
+                timed->process(_now);
+                any = true;
+            }
+        }
+    } while(any);
+}
+
+// moves the time forward, the events on the way happen in order
+void runUntil(uint64_t target) {
+    for(;;) {
+        uint64_t next = nextEventTime();
+        if(next > target) {
+            break;
+        }
+        if(next >= _end) {
+            _now = _end;
+            finish();
+        }
+        _now = std::max(_now, next);
+        processDue();
+    }
+    if(target >= _end) {
+        _now = _end;
+        finish();
+    }
+    _now = std::max(_now, target);
+}
+
+template<typename T>
+Reg<T>& mutableReg(const void* reg) {
+    return *const_cast<Reg<T>*>(static_cast<const Reg<T>*>(reg));
+}
+
+class SysTickModel;
+class ExtiModel;
+class DmaModel;
+class I2cModel;
+SysTickModel& sysTickModel();
+ExtiModel& extiModel();
+DmaModel& dmaModel();
+I2cModel& i2cModel();
+
+// HCLK follows the switch status and the AHB prescaler, oscillators are ready as soon as they are on
+class RccModel : public Peripheral {
+public:
+    RccModel() {
+        rcc.model = this;
+        rcc.CTLR.poke(RCC_HSION | RCC_HSIRDY);
+    }
+    uint32_t read(const void* reg) override {
+        return mutableReg<uint32_t>(reg).peek();
+    }
+    void write(const void* reg, uint32_t value) override;
+    // standby ends on HSI with the PLL and HSE off
+    void wakeUp();
+private:
+    static bool isReady(uint32_t source) {
+        uint32_t ctlr = rcc.CTLR.peek();
+        switch(source) {
+        case RCC_SW_HSI:
+            return (ctlr & RCC_HSIRDY) != 0;
+        case RCC_SW_HSE:
+            return (ctlr & RCC_HSERDY) != 0;
+        case RCC_SW_PLL:
+            return (ctlr & RCC_PLLRDY) != 0;
+        default:
+            return false;
+        }
+    }
+    static uint32_t getAhbDivider(uint32_t cfgr) {
+        uint32_t hpre = (cfgr & RCC_HPRE) >> 4;
+        if(hpre < 8) {
+            return hpre + 1;
+        }
+        static constexpr uint32_t high[8] = {2, 4, 8, 16, 32, 64, 128, 256};
+        return high[hpre - 8];
+    }
+    void setConfig(uint32_t cfgr);
+};
+
+void RccModel::write(const void* reg, uint32_t value) {
+    if(reg == &rcc.CTLR) {
+        value &= ~(RCC_HSIRDY | RCC_HSERDY | RCC_PLLRDY);
+        if(value & RCC_HSION) { value |= RCC_HSIRDY; }
+        if(value & RCC_HSEON) { value |= RCC_HSERDY; }
+        if(value & RCC_PLLON) { value |= RCC_PLLRDY; }
+        rcc.CTLR.poke(value);
+    } else if(reg == &rcc.CFGR0) {
+        uint32_t status = rcc.CFGR0.peek() & RCC_SWS;
+        if(isReady(value & RCC_SW)) {
+            status = (value & RCC_SW) << 2;
+        }
+        setConfig((value & ~RCC_SWS) | status);
+    } else if(reg == &rcc.RSTSCKR) {
+        value &= ~RCC_LSIRDY;
+        if(value & RCC_LSION) { value |= RCC_LSIRDY; }
+        rcc.RSTSCKR.poke(value);
+    } else {
+        mutableReg<uint32_t>(reg).poke(value);
+    }
+}
+
+void RccModel::wakeUp() {
+    rcc.CTLR.poke(rcc.CTLR.peek() & ~(RCC_PLLON | RCC_PLLRDY | RCC_HSEON | RCC_HSERDY));
+    setConfig(rcc.CFGR0.peek() & ~(RCC_SW | RCC_SWS));
+}
+
+class SysTickModel : public Peripheral, public Timed {
+public:
+    SysTickModel() {
+        sysTick.model = this;
+    }
+    uint32_t read(const void* reg) override {
+        sync();
+        if(reg == &sysTick.CNT) {
+            return _count;
+        }
+        return mutableReg<uint32_t>(reg).peek();
+    }
+    void write(const void* reg, uint32_t value) override {
+        sync();
+        if(reg == &sysTick.CNT) {
+            _count = value;
+            _last = _now;
+        } else {
+            if(reg == &sysTick.CTLR && !(sysTick.CTLR.peek() & STK_CTLR_STE)) {
+                _last = _now;
+            }
+            mutableReg<uint32_t>(reg).poke(value);
+        }
+    }
+    uint64_t nextEvent() override {
+        uint32_t ctlr = sysTick.CTLR.peek();
+        if(!isRunning() || !(ctlr & STK_CTLR_STIE) || (sysTick.SR.peek() & 1)) {
+            return NEVER;
+        }
+        sync();
+        uint32_t compare = sysTick.CMP.peek();
+        uint64_t counts;
+        if(_count < compare) {
+            counts = compare - _count;
+        } else if(_count == compare) {
+            counts = static_cast<uint64_t>(compare) + 1;
+        } else {
+            counts = (1ULL << 32) - _count + compare;
+        }
+        return _last + counts * getCountUnits();
+    }
+    void process(uint64_t) override {
+        sync();
+    }
+    bool isIrqActive() {
+        return (sysTick.CTLR.peek() & STK_CTLR_STIE) && (sysTick.SR.peek() & 1);
+    }
+    // brings the counter up to now, called before the clock or the standby state changes
+    void sync() {
+        if(!isRunning()) {
+            _last = _now;
+            return;
+        }
+        uint64_t units = getCountUnits();
+        uint64_t counts = (_now - _last) / units;
+        _last += counts * units;
+        count(counts);
+    }
+    void restart() {
+        _last = _now;
+    }
+private:
+    static constexpr uint32_t STK_CTLR_STE = 0x00000001;
+    static constexpr uint32_t STK_CTLR_STIE = 0x00000002;
+    static constexpr uint32_t STK_CTLR_STCLK = 0x00000004;
+    static constexpr uint32_t STK_CTLR_STRE = 0x00000008;
+
+    uint32_t _count = 0;
+    uint64_t _last = 0;
+
+    bool isRunning() {
+        return (sysTick.CTLR.peek() & STK_CTLR_STE) && !_standby;
+    }
+    uint64_t getCountUnits() {
+        return (sysTick.CTLR.peek() & STK_CTLR_STCLK) ? _cycleUnits : 8 * _cycleUnits;
+    }
+    // counts up, the flag is set on reaching the compare value, with STRE the next count is 0
+    void count(uint64_t counts) {
+        if(counts == 0) {
+            return;
+        }
+        uint32_t compare = sysTick.CMP.peek();
+        if(_count > compare) {
+            uint64_t toWrap = (1ULL << 32) - _count;
+            if(counts < toWrap) {
+                _count += static_cast<uint32_t>(counts);
+                return;
+            }
+            counts -= toWrap;
+            _count = 0;
+        }
+        uint64_t toMatch = compare - _count;
+        if(counts < toMatch) {
+            _count += static_cast<uint32_t>(counts);
+            return;
+        }
+        sysTick.SR.poke(sysTick.SR.peek() | 1);
+        uint64_t rest = counts - toMatch;
+        if(!(sysTick.CTLR.peek() & STK_CTLR_STRE)) {
+            _count = static_cast<uint32_t>(compare + rest);
+        } else if(rest == 0) {
+            _count = compare;
+        } else {
+            _count = static_cast<uint32_t>((rest - 1) % (static_cast<uint64_t>(compare) + 1));
+        }
+    }
+};
+
+void RccModel::setConfig(uint32_t cfgr) {
+    sysTickModel().sync();
+    rcc.CFGR0.poke(cfgr);
+    uint32_t sysClock = HSI_CLOCK;
+    switch((cfgr & RCC_SWS) >> 2) {
+    case RCC_SW_HSE:
+        sysClock = HSE_CLOCK;
+        break;
+    case RCC_SW_PLL:
+        sysClock = ((cfgr & RCC_PLLSRC) ? HSE_CLOCK : HSI_CLOCK) * 2;
+        break;
+    }
+    uint64_t cycleUnits = UNITS_PER_SECOND / sysClock * getAhbDivider(cfgr);
+    if(cycleUnits != _cycleUnits) {
+        _cycleUnits = cycleUnits;
+        _clockSwitches++;
+    }
+    sysTickModel().restart();
+}
+
+// Input levels come from the output latch, the pull resistors and the pins driven from outside,
+// level changes of the selected port raise the EXTI lines
+class GpioModel : public Peripheral {
+public:
+    GpioModel(GPIO_TypeDef& regs, Port port) : _regs(regs), _port(port) {
+        _regs.model = this;
+        // inputs floating after reset
+        _regs.CFGLR.poke(0x44444444);
+    }
+    uint32_t read(const void* reg) override {
+        if(reg == &_regs.INDR) {
+            return getLevels();
+        }
+        if(reg == &_regs.BSHR || reg == &_regs.BCR) {
+            return 0;
+        }
+        return mutableReg<uint32_t>(reg).peek();
+    }
+    void write(const void* reg, uint32_t value) override {
+        uint8_t before = getLevels();
+        if(reg == &_regs.BSHR) {
+            _regs.OUTDR.poke((_regs.OUTDR.peek() | (value & 0xFFFF)) & ~(value >> 16));
+        } else if(reg == &_regs.BCR) {
+            _regs.OUTDR.poke(_regs.OUTDR.peek() & ~(value & 0xFFFF));
+        } else if(reg != &_regs.INDR) {
+            mutableReg<uint32_t>(reg).poke(value);
+        }
+        changed(before);
+    }
+    void drive(uint8_t pin, bool low) {
+        uint8_t before = getLevels();
+        if(low) {
+            _drivenLow |= 1 << pin;
+        } else {
+            _drivenLow &= ~(1 << pin);
+        }
+        changed(before);
+    }
+    uint8_t getLevels() {
+        uint32_t config = _regs.CFGLR.peek();
+        uint32_t out = _regs.OUTDR.peek();
+        uint8_t levels = 0;
+        for(uint8_t pin = 0; pin < 8; pin++) {
+            uint8_t mode = (config >> (pin * 4)) & 0b11;
+            uint8_t cnf = (config >> (pin * 4 + 2)) & 0b11;
+            bool released = !(_drivenLow & (1 << pin));
+            bool level;
+            if(mode != 0) {
+                // open drain and alternate open drain only pull low
+                level = (out & (1 << pin)) && (released || !(cnf & 0b01));
+            } else if(!released) {
+                level = false;
+            } else if(cnf == 0b10) {
+                level = (out & (1 << pin)) != 0;
+            } else {
+                // floating inputs see the board pull-ups, e.g. on SDA/SCL
+                level = true;
+            }
+            levels |= level ? (1 << pin) : 0;
+        }
+        return levels;
+    }
+private:
+    GPIO_TypeDef& _regs;
+    Port _port;
+    uint8_t _drivenLow = 0;
+
+    void changed(uint8_t before);
+};
+
+class ExtiModel : public Peripheral {
+public:
+    ExtiModel() {
+        exti.model = this;
+    }
+    uint32_t read(const void* reg) override {
+        return mutableReg<uint32_t>(reg).peek();
+    }
+    void write(const void* reg, uint32_t value) override {
+        if(reg == &exti.INTFR) {
+            exti.INTFR.poke(exti.INTFR.peek() & ~value);
+        } else {
+            mutableReg<uint32_t>(reg).poke(value);
+        }
+    }
+    void edges(Port port, uint8_t rising, uint8_t falling) {
+        static constexpr uint8_t PORT_SELECT[3] = {0b00, 0b10, 0b11};
+        uint32_t select = afio.EXTICR.peek();
+        for(uint8_t line = 0; line < 8; line++) {
+            if(((select >> (line * 2)) & 0b11) != PORT_SELECT[static_cast<uint8_t>(port)]) {
+                continue;
+            }
+            uint32_t mask = 1 << line;
+            if(((rising & mask) && (exti.RTENR.peek() & mask)) || ((falling & mask) && (exti.FTENR.peek() & mask))) {
+                exti.INTFR.poke(exti.INTFR.peek() | mask);
+            }
+        }
+    }
+    // internal lines (AWU) have a single event, either edge enable catches it
+    void raise(uint8_t line) {
+        uint32_t mask = 1 << line;
+        if((exti.RTENR.peek() | exti.FTENR.peek()) & mask) {
+            exti.INTFR.poke(exti.INTFR.peek() | mask);
+        }
+    }
+    bool isIrqActive(uint32_t lines) {
+        return (exti.INTFR.peek() & exti.INTENR.peek() & lines) != 0;
+    }
+};
+
+void GpioModel::changed(uint8_t before) {
+    uint8_t after = getLevels();
+    if(after != before) {
+        extiModel().edges(_port, after & ~before, before & ~after);
+    }
+}
+
+// AWU counts the prescaled LSI up to the window value, runs in standby too
+class PwrModel : public Peripheral, public Timed {
+public:
+    PwrModel() {
+        pwr.model = this;
+    }
+    uint32_t read(const void* reg) override {
+        return mutableReg<uint32_t>(reg).peek();
+    }
+    void write(const void* reg, uint32_t value) override {
+        if(reg == &pwr.AWUCSR && (value & AWUEN) && !(pwr.AWUCSR.peek() & AWUEN)) {
+            _start = _now;
+        }
+        mutableReg<uint32_t>(reg).poke(value);
+    }
+    uint64_t nextEvent() override {
+        if(!(pwr.AWUCSR.peek() & AWUEN)) {
+            return NEVER;
+        }
+        return _start + getPeriod();
+    }
+    void process(uint64_t time) override {
+        uint64_t period = getPeriod();
+        while(_start + period <= time) {
+            _start += period;
+            extiModel().raise(AWU_LINE);
+        }
+    }
+private:
+    uint64_t _start = 0;
+
+    static uint64_t getPeriod() {
+        uint64_t window = pwr.AWUWR.peek() & 0x3F;
+        uint32_t prescaler = pwr.AWUPSC.peek() & 0x0F;
+        uint64_t divider = prescaler < 2 ? 1 : (1ULL << (prescaler - 1));
+        return std::max<uint64_t>(window, 1) * divider * UNITS_PER_SECOND / LSI_CLOCK;
+    }
+};
+
+// Only memory to peripheral transfers for the I2C transmit channel move data,
+// the request comes from the I2C model whenever its data register is empty
+class DmaModel : public Peripheral {
+public:
+    DmaModel() {
+        dma1.model = this;
+        for(DMA_Channel_TypeDef& channel : dma1Channels) {
+            channel.model = this;
+        }
+    }
+    uint32_t read(const void* reg) override {
+        if(reg == &dma1.INTFCR) {
+            return 0;
+        }
+        for(uint8_t i = 0; i < 7; i++) {
+            if(reg == &dma1Channels[i].CNTR && (dma1Channels[i].CFGR.peek() & DMA_CFGR1_EN)) {
+                return _remaining[i];
+            }
+        }
+        return mutableReg<uint32_t>(reg).peek();
+    }
+    void write(const void* reg, uint32_t value) override;
+    bool takeByte(uint8_t channel, uint32_t peripheral, uint8_t& byte) {
+        DMA_Channel_TypeDef& regs = dma1Channels[channel - 1];
+        uint32_t config = regs.CFGR.peek();
+        uint8_t i = channel - 1;
+        if(!(config & DMA_CFGR1_EN) || !(config & DMA_CFGR1_DIR) || _remaining[i] == 0) {
+            return false;
+        }
+        uint32_t shift = i * 4;
+        if(regs.PADDR.peek() != peripheral) {
+            std::fprintf(stderr, "sim: DMA channel %u peripheral address 0x%08x is not the I2C data register\n",
+                         channel, regs.PADDR.peek());
+            dma1.INTFR.poke(dma1.INTFR.peek() | ((DMA_GIF1 | DMA_TEIF1) << shift));
+            regs.CFGR.poke(config & ~DMA_CFGR1_EN);
+            return false;
+        }
+        byte = *reinterpret_cast<const uint8_t*>(static_cast<uintptr_t>(_memory[i]));
+        if(config & DMA_CFGR1_MINC) {
+            _memory[i]++;
+        }
+        if(--_remaining[i] == 0) {
+            dma1.INTFR.poke(dma1.INTFR.peek() | ((DMA_GIF1 | DMA_TCIF1) << shift));
+        }
+        return true;
+    }
+    bool isIrqActive(uint8_t channel) {
+        uint32_t config = dma1Channels[channel - 1].CFGR.peek();
+        uint32_t flags = dma1.INTFR.peek() >> ((channel - 1) * 4);
+        return ((config & DMA_CFGR1_TCIE) && (flags & DMA_TCIF1)) || ((config & DMA_CFGR1_TEIE) && (flags & DMA_TEIF1));
+    }
+private:
+    uint32_t _memory[7] = {};
+    uint16_t _remaining[7] = {};
+};
+
+class I2cModel : public Peripheral, public Timed {
+public:
+    I2cModel() {
+        i2c1.model = this;
+    }
+    void attach(I2cDevice& device) {
+        _devices.push_back(&device);
+    }
+    const I2cStats& getStats(uint8_t address) {
+        return _stats[address & 0x7F];
+    }
+    uint32_t read(const void* reg) override {
+        if(reg == &i2c1.STAR1) {
+            uint16_t status = getStatus1();
+            if(status & I2C_STAR1_ADDR) {
+                _addrRead = true;
+            }
+            return status;
+        }
+        if(reg == &i2c1.STAR2) {
+            uint16_t status = getStatus2();
+            if(_addrRead) {
+                clearAddr();
+            }
+            return status;
+        }
+        if(reg == &i2c1.CTLR1 || reg == &i2c1.CTLR2) {
+            releaseAddr();
+        } else if(reg == &i2c1.DATAR) {
+            releaseAddr();
+            return readData();
+        }
+        return mutableReg<uint16_t>(reg).peek();
+    }
+    void write(const void* reg, uint32_t value) override {
+        if(reg == &i2c1.CTLR1) {
+            releaseAddr();
+            writeControl1(static_cast<uint16_t>(value));
+        } else if(reg == &i2c1.CTLR2) {
+            releaseAddr();
+            i2c1.CTLR2.poke(static_cast<uint16_t>(value));
+            serviceDma();
+        } else if(reg == &i2c1.DATAR) {
+            releaseAddr();
+            writeData(static_cast<uint8_t>(value));
+        } else if(reg == &i2c1.STAR1) {
+            // the error flags are cleared by writing 0
+            _status1 &= static_cast<uint16_t>(value | ~ERROR_FLAGS);
+        } else if(reg != &i2c1.STAR2) {
+            mutableReg<uint16_t>(reg).poke(static_cast<uint16_t>(value));
+        }
+    }
+    void setStalled(bool stalled) {
+        // the operation on the bus goes on from where it was held
+        if(_stalled && !stalled && _operation != Operation::none) {
+            _doneAt = std::max(_doneAt, _now);
+        }
+        _stalled = stalled;
+    }
+    uint64_t nextEvent() override {
+        return (_operation != Operation::none && !_standby && !_stalled) ? _doneAt : NEVER;
+    }
+    void process(uint64_t) override {
+        complete();
+    }
+    bool isEventIrqActive() {
+        uint16_t control = i2c1.CTLR2.peek();
+        uint16_t status = getStatus1();
+        if(!(control & I2C_CTLR2_ITEVTEN)) {
+            return false;
+        }
+        if(status & (I2C_STAR1_SB | I2C_STAR1_ADDR | I2C_STAR1_BTF | I2C_STAR1_STOPF | I2C_STAR1_ADD10)) {
+            return true;
+        }
+        return (control & I2C_CTLR2_ITBUFEN) && (status & (I2C_STAR1_TXE | I2C_STAR1_RXNE));
+    }
+    bool isErrorIrqActive() {
+        return (i2c1.CTLR2.peek() & I2C_CTLR2_ITERREN) && (_status1 & ERROR_FLAGS);
+    }
+    void serviceDma();
+private:
+    static constexpr uint16_t ERROR_FLAGS = I2C_STAR1_BERR | I2C_STAR1_ARLO | I2C_STAR1_AF | I2C_STAR1_OVR;
+    enum struct Operation : uint8_t {none, start, address, transmit, receive, stop};
+
+    std::vector<I2cDevice*> _devices;
+    I2cStats _stats[128] = {};
+    I2cDevice* _target = nullptr;
+    uint8_t _targetAddress = 0;
+    Operation _operation = Operation::none;
+    uint64_t _doneAt = 0;
+    bool _stalled = false;
+    uint16_t _status1 = 0;
+    bool _master = false;
+    bool _transmitter = false;
+    bool _addrRead = false;
+    uint8_t _shift = 0;
+    uint8_t _data = 0;
+    bool _dataFull = false;
+    // received byte waiting in the shift register while DATAR is still full (BTF)
+    bool _held = false;
+    uint8_t _heldByte = 0;
+    bool _heldAck = false;
+
+    uint16_t getStatus1() {
+        bool txEmpty = _master && _transmitter && !_dataFull;
+        return _status1 | (txEmpty ? I2C_STAR1_TXE : 0);
+    }
+    uint16_t getStatus2() {
+        return (_master ? (I2C_STAR2_MSL | I2C_STAR2_BUSY) : 0) | (_transmitter ? I2C_STAR2_TRA : 0);
+    }
+    // one SCL period on the current HCLK
+    uint64_t getBitUnits() {
+        uint16_t config = i2c1.CKCFGR.peek();
+        uint64_t ccr = std::max<uint16_t>(config & I2C_CKCFGR_CCR, 1);
+        uint64_t cycles;
+        if(!(config & I2C_CKCFGR_FS)) {
+            cycles = 2 * ccr;
+        } else {
+            cycles = (config & I2C_CKCFGR_DUTY) ? 25 * ccr : 3 * ccr;
+        }
+        return cycles * _cycleUnits;
+    }
+    void begin(Operation operation, uint64_t bits) {
+        _operation = operation;
+        _doneAt = _now + bits * getBitUnits();
+    }
+    bool isConditionRequested() {
+        return (i2c1.CTLR1.peek() & (I2C_CTLR1_START | I2C_CTLR1_STOP)) != 0;
+    }
+    // START and STOP wait for the byte on the bus, STOP wins
+    void startConditions() {
+        uint16_t control = i2c1.CTLR1.peek();
+        if(_operation != Operation::none || !(control & I2C_CTLR1_PE)) {
+            return;
+        }
+        if(control & I2C_CTLR1_STOP) {
+            if(_master) {
+                begin(Operation::stop, 1);
+            } else {
+                i2c1.CTLR1.poke(control & ~I2C_CTLR1_STOP);
+            }
+        } else if(control & I2C_CTLR1_START) {
+            begin(Operation::start, 1);
+        }
+    }
+    void resetState() {
+        if(_target != nullptr) {
+            _target->stop();
+            _target = nullptr;
+        }
+        _operation = Operation::none;
+        _status1 = 0;
+        _master = false;
+        _transmitter = false;
+        _addrRead = false;
+        _dataFull = false;
+        _held = false;
+    }
+    void writeControl1(uint16_t value) {
+        if(value & I2C_CTLR1_SWRST) {
+            resetState();
+            i2c1.CTLR2.poke(0);
+            i2c1.CKCFGR.poke(0);
+            // the reset clears the requested START and STOP as well
+            i2c1.CTLR1.poke(I2C_CTLR1_SWRST);
+            return;
+        }
+        i2c1.CTLR1.poke(value);
+        if(!(value & I2C_CTLR1_PE)) {
+            resetState();
+            return;
+        }
+        startConditions();
+    }
+    // ADDR is cleared by reading STAR1 and then STAR2. A discarded STAR2 read does not reach the model,
+    // so the next access to the control or data registers after STAR1 showed ADDR clears it as well.
+    void releaseAddr() {
+        if(_addrRead && (_status1 & I2C_STAR1_ADDR)) {
+            clearAddr();
+        }
+    }
+    void clearAddr() {
+        _addrRead = false;
+        if(!(_status1 & I2C_STAR1_ADDR)) {
+            return;
+        }
+        _status1 &= ~I2C_STAR1_ADDR;
+        if(!_transmitter) {
+            if(i2c1.CTLR1.peek() & I2C_CTLR1_STOP) {
+                startConditions();
+            } else {
+                begin(Operation::receive, 9);
+            }
+        } else if(_dataFull) {
+            _dataFull = false;
+            transmit(_data);
+        }
+        serviceDma();
+    }
+    void transmit(uint8_t byte) {
+        _shift = byte;
+        begin(Operation::transmit, 9);
+    }
+    void writeData(uint8_t byte) {
+        if(_status1 & I2C_STAR1_SB) {
+            _status1 &= ~I2C_STAR1_SB;
+            _shift = byte;
+            begin(Operation::address, 9);
+            return;
+        }
+        _data = byte;
+        if(!_master || !_transmitter) {
+            return;
+        }
+        _status1 &= ~I2C_STAR1_BTF;
+        if(_operation == Operation::none && !(_status1 & I2C_STAR1_ADDR) && !_dataFull) {
+            transmit(byte);
+        } else {
+            _dataFull = true;
+        }
+    }
+    uint8_t readData() {
+        uint8_t byte = _data;
+        if(_status1 & I2C_STAR1_RXNE) {
+            _status1 &= ~I2C_STAR1_RXNE;
+            if(_held) {
+                _held = false;
+                _data = _heldByte;
+                _status1 = (_status1 | I2C_STAR1_RXNE) & ~I2C_STAR1_BTF;
+                if(isConditionRequested()) {
+                    startConditions();
+                } else if(_heldAck) {
+                    begin(Operation::receive, 9);
+                }
+            }
+        }
+        return byte;
+    }
+    I2cDevice* findDevice(uint8_t address) {
+        for(I2cDevice* device : _devices) {
+            if(device->getAddress() == address) {
+                return device;
+            }
+        }
+        return nullptr;
+    }
+    void complete() {
+        Operation operation = _operation;
+        _operation = Operation::none;
+        switch(operation) {
+        case Operation::start:
+            i2c1.CTLR1.poke(i2c1.CTLR1.peek() & ~I2C_CTLR1_START);
+            _master = true;
+            _transmitter = false;
+            _status1 = (_status1 & ERROR_FLAGS) | I2C_STAR1_SB;
+            _dataFull = false;
+            _held = false;
+            _addrRead = false;
+            break;
+        case Operation::address: {
+            bool read = (_shift & 1) != 0;
+            _targetAddress = _shift >> 1;
+            _target = findDevice(_targetAddress);
+            if(_target != nullptr && _target->start(read)) {
+                _stats[_targetAddress].transactions++;
+                _status1 |= I2C_STAR1_ADDR;
+                _transmitter = !read;
+            } else {
+                _stats[_targetAddress].nacks++;
+                _target = nullptr;
+                _status1 |= I2C_STAR1_AF;
+            }
+            startConditions();
+            break;
+        }
+        case Operation::transmit:
+            if(_target != nullptr && _target->write(_shift)) {
+                _stats[_targetAddress].bytesWritten++;
+                if(isConditionRequested()) {
+                    startConditions();
+                } else if(_dataFull) {
+                    _dataFull = false;
+                    transmit(_data);
+                } else {
+                    _status1 |= I2C_STAR1_BTF;
+                }
+            } else {
+                _stats[_targetAddress].nacks++;
+                _status1 |= I2C_STAR1_AF;
+                startConditions();
+            }
+            serviceDma();
+            break;
+        case Operation::receive: {
+            uint8_t byte = _target != nullptr ? _target->read() : 0xFF;
+            bool ack = (i2c1.CTLR1.peek() & I2C_CTLR1_ACK) != 0;
+            _stats[_targetAddress].bytesRead++;
+            if(!(_status1 & I2C_STAR1_RXNE)) {
+                _data = byte;
+                _status1 |= I2C_STAR1_RXNE;
+                if(isConditionRequested()) {
+                    startConditions();
+                } else if(ack) {
+                    begin(Operation::receive, 9);
+                }
+            } else {
+                _held = true;
+                _heldByte = byte;
+                _heldAck = ack;
+                _status1 |= I2C_STAR1_BTF;
+            }
+            break;
+        }
+        case Operation::stop:
+            i2c1.CTLR1.poke(i2c1.CTLR1.peek() & ~I2C_CTLR1_STOP);
+            if(_target != nullptr) {
+                _target->stop();
+                _target = nullptr;
+            }
+            _master = false;
+            _transmitter = false;
+            // the last received byte can still be read
+            _status1 &= (I2C_STAR1_RXNE | ERROR_FLAGS);
+            _dataFull = false;
+            _held = false;
+            startConditions();
+            break;
+        case Operation::none:
+            break;
+        }
+    }
+};
+
+void DmaModel::write(const void* reg, uint32_t value) {
+    if(reg == &dma1.INTFCR) {
+        // clearing the global flag of a channel clears all of its flags
+        for(uint8_t i = 0; i < 7; i++) {
+            if(value & (DMA_GIF1 << (i * 4))) {
+                value |= 0x0F << (i * 4);
+            }
+        }
+        dma1.INTFR.poke(dma1.INTFR.peek() & ~value);
+        return;
+    }
+    if(reg == &dma1.INTFR) {
+        return;
+    }
+    for(uint8_t i = 0; i < 7; i++) {
+        DMA_Channel_TypeDef& channel = dma1Channels[i];
+        if(reg == &channel.CFGR) {
+            bool enabled = !(channel.CFGR.peek() & DMA_CFGR1_EN) && (value & DMA_CFGR1_EN);
+            channel.CFGR.poke(value);
+            if(enabled) {
+                _memory[i] = channel.MADDR.peek();
+                _remaining[i] = static_cast<uint16_t>(channel.CNTR.peek());
+                i2cModel().serviceDma();
+            }
+            return;
+        }
+    }
+    mutableReg<uint32_t>(reg).poke(value);
+}
+
+// the data register takes DMA bytes as long as it is empty and the address phase is over
+void I2cModel::serviceDma() {
+    uint32_t peripheral = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(&i2c1.DATAR));
+    while((i2c1.CTLR2.peek() & I2C_CTLR2_DMAEN) && (getStatus1() & I2C_STAR1_TXE)
+          && !(_status1 & (I2C_STAR1_ADDR | ERROR_FLAGS))) {
+        uint8_t byte;
+        if(!dmaModel().takeByte(I2C_DMA_CHANNEL, peripheral, byte)) {
+            break;
+        }
+        writeData(byte);
+    }
+}
+
+class FlashModel : public Peripheral {
+public:
+    FlashModel() {
+        flash.model = this;
+    }
+    uint32_t read(const void* reg) override {
+        return mutableReg<uint32_t>(reg).peek();
+    }
+    void write(const void* reg, uint32_t value) override {
+        mutableReg<uint32_t>(reg).poke(value);
+    }
+};
+
+struct Board {
+    RccModel rccModel;
+    SysTickModel sysTickModel;
+    GpioModel gpioA{sim::gpioA, Port::A};
+    GpioModel gpioC{sim::gpioC, Port::C};
+    GpioModel gpioD{sim::gpioD, Port::D};
+    ExtiModel extiModel;
+    PwrModel pwrModel;
+    DmaModel dmaModel;
+    I2cModel i2cModel;
+    FlashModel flashModel;
+
+    Board() {
+        _timed.push_back(&sysTickModel);
+        _timed.push_back(&pwrModel);
+        _timed.push_back(&i2cModel);
+    }
+    GpioModel& getPort(Port port) {
+        switch(port) {
+        case Port::A:
+            return gpioA;
+        case Port::C:
+            return gpioC;
+        default:
+            return gpioD;
+        }
+    }
+};
+
+Board& board() {
+    static Board instance;
+    return instance;
+}
+SysTickModel& sysTickModel() { return board().sysTickModel; }
+ExtiModel& extiModel() { return board().extiModel; }
+DmaModel& dmaModel() { return board().dmaModel; }
+I2cModel& i2cModel() { return board().i2cModel; }
+
+struct Interrupt {
+    IRQn_Type irq;
+    void (*handler)(void);
+    bool (*isActive)();
+};
+const Interrupt INTERRUPTS[] = {
+    {SysTicK_IRQn, SysTick_Handler, []() { return sysTickModel().isIrqActive(); }},
+    {EXTI7_0_IRQn, EXTI7_0_IRQHandler, []() { return extiModel().isIrqActive(0xFF); }},
+    {AWU_IRQn, AWU_IRQHandler, []() { return extiModel().isIrqActive(1 << AWU_LINE); }},
+    {DMA1_Channel6_IRQn, DMA1_Channel6_IRQHandler, []() { return dmaModel().isIrqActive(I2C_DMA_CHANNEL); }},
+    {I2C1_EV_IRQn, I2C1_EV_IRQHandler, []() { return i2cModel().isEventIrqActive(); }},
+    {I2C1_ER_IRQn, I2C1_ER_IRQHandler, []() { return i2cModel().isErrorIrqActive(); }},
+};
+
+// enabled and pending, regardless of the global interrupt enable
+const Interrupt* findPending() {
+    for(const Interrupt& interrupt : INTERRUPTS) {
+        if(((_enabledIrqs >> interrupt.irq) & 1) && interrupt.isActive()) {
+            return &interrupt;
+        }
+    }
+    return nullptr;
+}
+
+// handlers run to completion, lines are level triggered and taken again while still active
+void deliverInterrupts() {
+    if(!_mie || _inHandler) {
+        return;
+    }
+    while(const Interrupt* interrupt = findPending()) {
+        _inHandler = true;
+        _interrupts++;
+        interrupt->handler();
+        _inHandler = false;
+        if(!_mie) {
+            return;
+        }
+    }
+}
+
+// WFI wakes on any enabled pending interrupt. With SLEEPDEEP and PDDS it is standby:
+// SysTick and the I2C engine stop, the AWU and the EXTI lines keep running, the core wakes on HSI.
+void waitForInterrupt() {
+    if(_inHandler) {
+        return;
+    }
+    bool deep = (pfic.SCTLR.peek() & SLEEPDEEP) && (pwr.CTLR.peek() & PWR_CTLR_PDDS);
+    if(deep) {
+        sysTickModel().sync();
+        _standby = true;
+    }
+    uint64_t start = _now;
+    uint64_t& residency = deep ? _standbyUnits : _sleepUnits;
+    while(findPending() == nullptr) {
+        uint64_t next = nextEventTime();
+        if(next >= _end) {
+            residency += _end - start;
+            start = _end;
+            _now = _end;
+            finish();
+        }
+        _now = std::max(_now, next);
+        processDue();
+    }
+    residency += _now - start;
+    if(deep) {
+        _standby = false;
+        board().rccModel.wakeUp();
+    }
+    deliverInterrupts();
+}
+
+} // namespace
+
+void beginAccess() {
+    _accesses.fetch_add(1, std::memory_order_relaxed);
+    board();
+    runUntil(_now + ACCESS_CYCLES * _cycleUnits);
+}
+
+void endAccess() {
+    deliverInterrupts();
+}
+
+uint64_t now() {
+    return _now;
+}
+
+void addTimed(Timed& timed) {
+    board();
+    _timed.push_back(&timed);
+}
+
+void attachI2c(I2cDevice& device) {
+    i2cModel().attach(device);
+}
+
+const I2cStats& getI2cStats(uint8_t address) {
+    return i2cModel().getStats(address);
+}
+
+void stallI2c(bool stalled) {
+    i2cModel().setStalled(stalled);
+}
+
+void drivePin(Port port, uint8_t pin, bool low) {
+    board().getPort(port).drive(pin, low);
+}
+
+Residency getResidency() {
+    return {_now - _sleepUnits - _standbyUnits, _sleepUnits, _standbyUnits};
+}
+
+uint32_t getInterruptCount() {
+    return _interrupts;
+}
+
+uint32_t getClockSwitches() {
+    return _clockSwitches;
+}
+
+uint64_t getAccessCount() {
+    return _accesses.load(std::memory_order_relaxed);
+}
+
+void setEnd(uint32_t endMs, std::function<void()> onEnd) {
+    _end = static_cast<uint64_t>(endMs) * UNITS_PER_MS;
+    _onEnd = std::move(onEnd);
+}
+
+void runFirmware(void (*entry)()) {
+    board();
+    entry();
+    std::fprintf(stderr, "sim: firmware returned at %u ms\n", nowMs());
+    _end = _now;
+    finish();
+}
+
+} // namespace sim
+
+using namespace sim;
+
+void __enable_irq(void) {
+    _mie = true;
+    deliverInterrupts();
+}
+
+void __disable_irq(void) {
+    _mie = false;
+}
+
+// only MIE and MPIE are modelled
+uint32_t __get_MSTATUS(void) {
+    return _mie ? 0x88 : 0;
+}
+
+void __set_MSTATUS(uint32_t value) {
+    _mie = (value & 0x08) != 0;
+    deliverInterrupts();
+}
+
+void __NOP(void) {
+    runUntil(_now + _cycleUnits);
+}
+
+void __WFI(void) {
+    waitForInterrupt();
+}
+
+void __WFE(void) {
+    waitForInterrupt();
+}
+
+void NVIC_EnableIRQ(IRQn_Type IRQn) {
+    _enabledIrqs |= 1ULL << IRQn;
+    deliverInterrupts();
+}
+
+void NVIC_DisableIRQ(IRQn_Type IRQn) {
+    _enabledIrqs &= ~(1ULL << IRQn);
+}
+
+uint32_t NVIC_GetStatusIRQ(IRQn_Type IRQn) {
+    return (_enabledIrqs >> IRQn) & 1;
+}
+
+void NVIC_SetPriority(IRQn_Type, uint8_t) {
+}
+
+void NVIC_SystemReset(void) {
+    std::fprintf(stderr, "sim: system reset requested at %u ms\n", nowMs());
+    _end = _now;
+    finish();
+}
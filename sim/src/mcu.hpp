@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+// Host model of the CH32V003 parts the firmware uses: RCC, SysTick, GPIO/EXTI, PWR with the AWU,
+// DMA and the I2C master. Time is virtual and only moves with register accesses and WFI, so a run
+// is deterministic and independent of the host speed.
+namespace sim {
+
+// 1 unit is one cycle of the fastest clock, 48 MHz
+constexpr uint64_t UNITS_PER_SECOND = 48000000;
+constexpr uint64_t UNITS_PER_MS = UNITS_PER_SECOND / 1000;
+constexpr uint64_t NEVER = UINT64_MAX;
+
+uint64_t now();
+inline uint32_t nowMs() {
+    return static_cast<uint32_t>(now() / UNITS_PER_MS);
+}
+
+// Anything that changes state on its own schedule: timers, the bus, the RTC chip, scripted input
+class Timed {
+public:
+    virtual uint64_t nextEvent() = 0;
+    // handles the events due at time, nextEvent() has to move past it
+    virtual void process(uint64_t time) = 0;
+protected:
+    ~Timed() = default;
+};
+void addTimed(Timed& timed);
+
+// I2C slave behind the master model, addressed with its 7 bit address
+class I2cDevice {
+public:
+    virtual uint8_t getAddress() const = 0;
+    // address byte, false for NACK
+    virtual bool start(bool read) = 0;
+    virtual bool write(uint8_t byte) = 0;
+    virtual uint8_t read() = 0;
+    virtual void stop() = 0;
+protected:
+    ~I2cDevice() = default;
+};
+void attachI2c(I2cDevice& device);
+
+struct I2cStats {
+    uint32_t transactions;
+    uint32_t bytesWritten;
+    uint32_t bytesRead;
+    uint32_t nacks;
+};
+const I2cStats& getI2cStats(uint8_t address);
+// A device holds SCL low: no START, byte, ACK or STOP completes until it is released
+void stallI2c(bool stalled);
+
+enum struct Port : uint8_t {A, C, D};
+// Pulls an input low from outside (button, open drain output), released pins follow their pull resistor
+void drivePin(Port port, uint8_t pin, bool low);
+
+struct Residency {
+    uint64_t run;
+    uint64_t sleep;
+    uint64_t standby;
+};
+Residency getResidency();
+uint32_t getInterruptCount();
+uint32_t getClockSwitches();
+// register accesses so far, tells a running firmware from a stuck one
+uint64_t getAccessCount();
+
+// The run ends when the virtual time reaches endMs, onEnd is called on the firmware thread before exit
+void setEnd(uint32_t endMs, std::function<void()> onEnd);
+// Sets up the board and calls the firmware entry on the calling thread, the run ends if it returns
+void runFirmware(void (*entry)());
+
+} // namespace sim
@@ -0,0 +1,270 @@
+// Runs the clock firmware on the host against the register models, an SSD1306 and a DS3231.
+// Button presses and the RTC time are scripted on the command line, every new picture on the
+// display is written as a PBM file and the run ends with a report of bus traffic, power state
+// residency and the latency from a press to the frame showing it.
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "mcu.hpp"
+#include "harness.hpp"
+#include "ds3231_model.hpp"
+#include "ssd1306_model.hpp"
+
+// src/clock.cpp
+void runClock();
+
+namespace {
+
+constexpr uint32_t BOUNCE_EDGES = 4;
+constexpr uint64_t BOUNCE_STEP = sim::UNITS_PER_MS / 4;
+
+struct Button {
+    const char* name;
+    uint8_t pin;
+};
+constexpr Button BUTTONS[] = {{"mode", 0}, {"plus", 3}, {"minus", 4}};
+
+struct Press {
+    const Button* button;
+    uint32_t atMs;
+    uint32_t holdMs;
+    // first frame after the press, 0 while none came
+    uint64_t frameAt;
+};
+
+// Button edges as pin levels on port C, optionally with contact bounce
+void addEdge(sim::PinScript& input, uint64_t time, uint8_t pin, bool low, bool bounce) {
+    if(bounce) {
+        for(uint32_t i = 0; i < BOUNCE_EDGES; i++) {
+            input.add(time + i * BOUNCE_STEP, sim::Port::C, pin, (i % 2 == 0) == low);
+        }
+        time += BOUNCE_EDGES * BOUNCE_STEP;
+    }
+    input.add(time, sim::Port::C, pin, low);
+}
+
+void addPress(sim::PinScript& input, const Press& press, bool bounce) {
+    uint64_t down = press.atMs * sim::UNITS_PER_MS;
+    uint64_t up = down + press.holdMs * sim::UNITS_PER_MS;
+    addEdge(input, down, press.button->pin, true, bounce);
+    addEdge(input, up, press.button->pin, false, bounce);
+}
+
+struct Options {
+    uint32_t durationMs = 3000;
+    Ds3231Model::DateTime rtc = {25, 1, 1, 12, 0, 0};
+    float temperature = 23.25f;
+    std::vector<Press> presses;
+    bool bounce = false;
+    std::string framesDir;
+    std::string reportFile;
+};
+
+struct FrameRecord {
+    uint32_t index;
+    uint64_t time;
+    uint32_t busBytes;
+};
+
+Options options;
+std::vector<FrameRecord> frames;
+Ds3231Model* rtc = nullptr;
+
+void usage(const char* name) {
+    std::fprintf(stderr,
+        "usage: %s [options]\n"
+        "  --duration MS           virtual time to run, default 3000\n"
+        "  --rtc \"YY-MM-DD hh:mm:ss\" time in the DS3231 at power on\n"
+        "  --temp C                DS3231 temperature, default 23.25\n"
+        "  --press BUTTON@MS[:HOLD] press mode, plus or minus at MS for HOLD ms (default 100), repeatable\n"
+        "  --bounce                add contact bounce to every press and release\n"
+        "  --frames DIR            write every new display picture to DIR/frame_NNNN.pbm\n"
+        "  --out FILE              write the report to FILE instead of stdout\n", name);
+}
+
+bool parsePress(const char* text, Press& press) {
+    const char* at = std::strchr(text, '@');
+    if(at == nullptr) {
+        return false;
+    }
+    std::string name(text, at);
+    press.button = nullptr;
+    for(const Button& button : BUTTONS) {
+        if(name == button.name) {
+            press.button = &button;
+        }
+    }
+    press.holdMs = 100;
+    press.frameAt = 0;
+    unsigned atMs = 0;
+    unsigned holdMs = 0;
+    int fields = std::sscanf(at + 1, "%u:%u", &atMs, &holdMs);
+    if(press.button == nullptr || fields < 1) {
+        return false;
+    }
+    press.atMs = atMs;
+    if(fields == 2) {
+        press.holdMs = holdMs;
+    }
+    return true;
+}
+
+bool parseOptions(int argc, char** argv) {
+    for(int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        bool hasValue = i + 1 < argc;
+        if(option == "--duration" && hasValue) {
+            options.durationMs = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if(option == "--rtc" && hasValue) {
+            unsigned year, month, date, hours, minutes, seconds;
+            if(std::sscanf(argv[++i], "%u-%u-%u %u:%u:%u", &year, &month, &date, &hours, &minutes, &seconds) != 6
+               || month < 1 || month > 12 || date < 1 || date > 31 || hours > 23 || minutes > 59 || seconds > 59) {
+                std::fprintf(stderr, "sim: bad --rtc value '%s'\n", argv[i]);
+                return false;
+            }
+            options.rtc = {static_cast<uint8_t>(year % 100), static_cast<uint8_t>(month), static_cast<uint8_t>(date),
+                           static_cast<uint8_t>(hours), static_cast<uint8_t>(minutes), static_cast<uint8_t>(seconds)};
+        } else if(option == "--temp" && hasValue) {
+            options.temperature = std::strtof(argv[++i], nullptr);
+        } else if(option == "--press" && hasValue) {
+            Press press;
+            if(!parsePress(argv[++i], press)) {
+                std::fprintf(stderr, "sim: bad --press value '%s'\n", argv[i]);
+                return false;
+            }
+            options.presses.push_back(press);
+        } else if(option == "--bounce") {
+            options.bounce = true;
+        } else if(option == "--frames" && hasValue) {
+            options.framesDir = argv[++i];
+        } else if(option == "--out" && hasValue) {
+            options.reportFile = argv[++i];
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// binary PBM, the time stamp goes into a comment
+void writeFrame(const Ssd1306Model::Frame& frame) {
+    char path[512];
+    std::snprintf(path, sizeof(path), "%s/frame_%04u.pbm", options.framesDir.c_str(), frame.index);
+    FILE* file = std::fopen(path, "wb");
+    if(file == nullptr) {
+        std::fprintf(stderr, "sim: can not write %s\n", path);
+        return;
+    }
+    std::fprintf(file, "P4\n# t=%.3f ms\n%u %u\n", static_cast<double>(frame.time) / sim::UNITS_PER_MS,
+                 Ssd1306Model::WIDTH, Ssd1306Model::HEIGHT);
+    for(uint8_t y = 0; y < Ssd1306Model::HEIGHT; y++) {
+        uint8_t row[Ssd1306Model::WIDTH / 8] = {};
+        for(uint8_t x = 0; x < Ssd1306Model::WIDTH; x++) {
+            if(frame.image[y * Ssd1306Model::WIDTH + x]) {
+                row[x / 8] |= static_cast<uint8_t>(0x80 >> (x % 8));
+            }
+        }
+        std::fwrite(row, 1, sizeof(row), file);
+    }
+    std::fclose(file);
+}
+
+void onFrame(const Ssd1306Model::Frame& frame) {
+    frames.push_back({frame.index, frame.time, frame.busBytes});
+    for(Press& press : options.presses) {
+        if(press.frameAt == 0 && frame.time >= press.atMs * sim::UNITS_PER_MS) {
+            press.frameAt = frame.time;
+        }
+    }
+    if(!options.framesDir.empty()) {
+        writeFrame(frame);
+    }
+}
+
+double toMs(uint64_t units) {
+    return static_cast<double>(units) / sim::UNITS_PER_MS;
+}
+
+void report() {
+    FILE* out = stdout;
+    if(!options.reportFile.empty()) {
+        out = std::fopen(options.reportFile.c_str(), "w");
+        if(out == nullptr) {
+            std::fprintf(stderr, "sim: can not write %s\n", options.reportFile.c_str());
+            out = stdout;
+        }
+    }
+    sim::Residency residency = sim::getResidency();
+    double total = std::max(toMs(sim::now()), 1.0);
+    std::fprintf(out, "time: %.3f ms\n", toMs(sim::now()));
+    std::fprintf(out, "run: %.3f ms (%.1f%%)\n", toMs(residency.run), 100 * toMs(residency.run) / total);
+    std::fprintf(out, "sleep: %.3f ms (%.1f%%)\n", toMs(residency.sleep), 100 * toMs(residency.sleep) / total);
+    std::fprintf(out, "standby: %.3f ms (%.1f%%)\n", toMs(residency.standby), 100 * toMs(residency.standby) / total);
+    std::fprintf(out, "interrupts: %u\n", sim::getInterruptCount());
+    std::fprintf(out, "clock switches: %u\n", sim::getClockSwitches());
+    for(uint8_t address : {Ds3231Model::ADDRESS, Ssd1306Model::ADDRESS}) {
+        const sim::I2cStats& stats = sim::getI2cStats(address);
+        std::fprintf(out, "i2c 0x%02X: %u transactions, %u bytes written, %u bytes read, %u NACKs\n",
+                     address, stats.transactions, stats.bytesWritten, stats.bytesRead, stats.nacks);
+    }
+    uint64_t frameBytes = 0;
+    uint32_t maxFrameBytes = 0;
+    for(const FrameRecord& frame : frames) {
+        frameBytes += frame.busBytes;
+        maxFrameBytes = std::max(maxFrameBytes, frame.busBytes);
+    }
+    std::fprintf(out, "frames: %zu, display bytes per frame avg %.1f max %u\n", frames.size(),
+                 frames.empty() ? 0.0 : static_cast<double>(frameBytes) / frames.size(), maxFrameBytes);
+    for(const FrameRecord& frame : frames) {
+        std::fprintf(out, "  frame %u at %.3f ms, %u bytes\n", frame.index, toMs(frame.time), frame.busBytes);
+    }
+    for(const Press& press : options.presses) {
+        if(press.frameAt == 0) {
+            std::fprintf(out, "press %s@%u: no frame\n", press.button->name, press.atMs);
+        } else {
+            std::fprintf(out, "press %s@%u: frame after %.3f ms\n", press.button->name, press.atMs,
+                         toMs(press.frameAt - press.atMs * sim::UNITS_PER_MS));
+        }
+    }
+    Ds3231Model::DateTime time = rtc->getDateTime();
+    std::fprintf(out, "rtc: %02u-%02u-%02u %02u:%02u:%02u\n", time.year, time.month, time.date,
+                 time.hours, time.minutes, time.seconds);
+    std::fflush(out);
+    if(out != stdout) {
+        std::fclose(out);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if(!parseOptions(argc, argv)) {
+        usage(argv[0]);
+        return 1;
+    }
+    if(!options.framesDir.empty()) {
+        mkdir(options.framesDir.c_str(), 0755);
+    }
+
+    static Ds3231Model ds3231(sim::Port::C, 7);
+    static Ssd1306Model ssd1306;
+    rtc = &ds3231;
+    ds3231.setDateTime(options.rtc);
+    ds3231.setTemperature(options.temperature);
+    ssd1306.setFrameCallback(onFrame);
+    static sim::PinScript input;
+    for(const Press& press : options.presses) {
+        addPress(input, press, options.bounce);
+    }
+    sim::setEnd(options.durationMs, report);
+    // returns only when the firmware did not start or got stuck
+    _exit(sim::runFirmwareThread(runClock));
+}
@@ -0,0 +1,181 @@
+#include "ssd1306_model.hpp"
+
+Ssd1306Model::Ssd1306Model() {
+    sim::addTimed(*this);
+    sim::attachI2c(*this);
+}
+
+bool Ssd1306Model::start(bool read) {
+    _expectControl = !read;
+    _lastTransfer = sim::now();
+    return true;
+}
+
+bool Ssd1306Model::write(uint8_t byte) {
+    _busBytes++;
+    _lastTransfer = sim::now();
+    if(_expectControl) {
+        _expectControl = false;
+        _singleByte = (byte & 0x80) != 0;
+        _data = (byte & 0x40) != 0;
+        return true;
+    }
+    if(_data) {
+        writeData(byte);
+    } else {
+        command(byte);
+    }
+    // Co = 1: only one byte follows, then the next control byte
+    _expectControl = _singleByte;
+    return true;
+}
+
+// status byte: D6 is set while the display is off
+uint8_t Ssd1306Model::read() {
+    return _displayOn ? 0x00 : 0x40;
+}
+
+void Ssd1306Model::stop() {
+    _lastTransfer = sim::now();
+    if(render() != _shown) {
+        _changed = true;
+        _changedAt = _lastTransfer;
+    }
+}
+
+uint64_t Ssd1306Model::nextEvent() {
+    return _changed ? _lastTransfer + SETTLE_MS * sim::UNITS_PER_MS : sim::NEVER;
+}
+
+void Ssd1306Model::process(uint64_t time) {
+    // a transfer came after the settle time was scheduled
+    if(time < _lastTransfer + SETTLE_MS * sim::UNITS_PER_MS) {
+        return;
+    }
+    _changed = false;
+    Image image = render();
+    if(image == _shown) {
+        return;
+    }
+    _shown = image;
+    _frames++;
+    if(_callback) {
+        _callback({_frames, _changedAt, _busBytes, _shown});
+    }
+    _busBytes = 0;
+}
+
+uint8_t Ssd1306Model::getCommandLength(uint8_t command) {
+    switch(command) {
+    case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3: case 0xD5:
+    case 0xD8: case 0xD9: case 0xDA: case 0xDB:
+        return 2;
+    case 0x21: case 0x22: case 0xA3:
+        return 3;
+    case 0x29: case 0x2A:
+        return 6;
+    case 0x26: case 0x27:
+        return 7;
+    default:
+        return 1;
+    }
+}
+
+void Ssd1306Model::command(uint8_t byte) {
+    if(_commandSize == 0) {
+        _commandLength = getCommandLength(byte);
+    }
+    _command[_commandSize++] = byte;
+    if(_commandSize == _commandLength) {
+        execute();
+        _commandSize = 0;
+    }
+}
+
+void Ssd1306Model::execute() {
+    uint8_t code = _command[0];
+    if(code <= 0x0F) {
+        _column = (_column & 0xF0) | code;
+    } else if(code <= 0x1F) {
+        _column = static_cast<uint8_t>((_column & 0x0F) | ((code & 0x07) << 4));
+    } else if(code >= 0x40 && code <= 0x7F) {
+        _startLine = code & 0x3F;
+    } else if(code >= 0xB0 && code <= 0xB7) {
+        _page = code & 0x07;
+    } else {
+        switch(code) {
+        case 0x20:
+            _addressing = _command[1] & 0x03;
+            break;
+        case 0x21:
+            _columnStart = _command[1] & 0x7F;
+            _columnEnd = _command[2] & 0x7F;
+            _column = _columnStart;
+            break;
+        case 0x22:
+            _pageStart = _command[1] & 0x07;
+            _pageEnd = _command[2] & 0x07;
+            _page = _pageStart;
+            break;
+        case 0xA0: case 0xA1:
+            _segmentRemap = code == 0xA1;
+            break;
+        case 0xA4: case 0xA5:
+            _entireOn = code == 0xA5;
+            break;
+        case 0xA6: case 0xA7:
+            _inverted = code == 0xA7;
+            break;
+        case 0xAE: case 0xAF:
+            _displayOn = code == 0xAF;
+            break;
+        case 0xC0: case 0xC8:
+            _comReverse = code == 0xC8;
+            break;
+        default:
+            // contrast, timing, charge pump and scrolling do not change the picture
+            break;
+        }
+    }
+}
+
+void Ssd1306Model::writeData(uint8_t byte) {
+    _ram[_page][_column] = byte;
+    switch(_addressing) {
+    case 0:
+        if(++_column > _columnEnd) {
+            _column = _columnStart;
+            if(++_page > _pageEnd) {
+                _page = _pageStart;
+            }
+        }
+        break;
+    case 1:
+        if(++_page > _pageEnd) {
+            _page = _pageStart;
+            if(++_column > _columnEnd) {
+                _column = _columnStart;
+            }
+        }
+        break;
+    default:
+        _column = (_column + 1) % WIDTH;
+        break;
+    }
+}
+
+Ssd1306Model::Image Ssd1306Model::render() const {
+    Image image = {};
+    if(!_displayOn) {
+        return image;
+    }
+    for(uint8_t y = 0; y < HEIGHT; y++) {
+        uint8_t row = static_cast<uint8_t>(((_comReverse ? HEIGHT - 1 - y : y) + _startLine) % HEIGHT);
+        for(uint8_t x = 0; x < WIDTH; x++) {
+            uint8_t column = _segmentRemap ? WIDTH - 1 - x : x;
+            bool lit = _entireOn || ((_ram[row / 8][column] >> (row % 8)) & 1);
+            image[y * WIDTH + x] = (lit != _inverted) ? 1 : 0;
+        }
+    }
+    return image;
+}
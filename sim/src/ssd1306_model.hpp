@@ -0,0 +1,91 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+
+#include "mcu.hpp"
+
+// SSD1306 128x64 panel on I2C: control bytes (Co, D/C), the fundamental, addressing and hardware
+// configuration commands, and the GDDRAM in page, horizontal and vertical addressing mode.
+// A frame is reported once the picture differs from the last one and the display has seen no
+// transfer for SETTLE_MS, so updates split over several transactions show up as one frame.
+class Ssd1306Model : public sim::I2cDevice, public sim::Timed {
+public:
+    static constexpr uint8_t ADDRESS = 0x3C;
+    static constexpr uint8_t WIDTH = 128;
+    static constexpr uint8_t HEIGHT = 64;
+    static constexpr uint8_t PAGES = HEIGHT / 8;
+    static constexpr uint32_t SETTLE_MS = 2;
+
+    // one byte per pixel as seen on the glass, 1 is lit
+    using Image = std::array<uint8_t, WIDTH * HEIGHT>;
+    struct Frame {
+        uint32_t index;
+        // end of the last transfer that changed the picture
+        uint64_t time;
+        // bytes the display received since the previous frame, control bytes included
+        uint32_t busBytes;
+        const Image& image;
+    };
+    using FrameCallback = std::function<void(const Frame&)>;
+
+    Ssd1306Model();
+
+    void setFrameCallback(FrameCallback callback) {
+        _callback = std::move(callback);
+    }
+    const Image& getImage() const {
+        return _shown;
+    }
+    uint32_t getFrameCount() const {
+        return _frames;
+    }
+
+    uint8_t getAddress() const override {
+        return ADDRESS;
+    }
+    bool start(bool read) override;
+    bool write(uint8_t byte) override;
+    uint8_t read() override;
+    void stop() override;
+
+    uint64_t nextEvent() override;
+    void process(uint64_t time) override;
+private:
+    uint8_t _ram[PAGES][WIDTH] = {};
+    bool _displayOn = false;
+    bool _inverted = false;
+    bool _entireOn = false;
+    bool _segmentRemap = false;
+    bool _comReverse = false;
+    uint8_t _startLine = 0;
+    uint8_t _addressing = 2;
+    uint8_t _columnStart = 0;
+    uint8_t _columnEnd = WIDTH - 1;
+    uint8_t _pageStart = 0;
+    uint8_t _pageEnd = PAGES - 1;
+    uint8_t _column = 0;
+    uint8_t _page = 0;
+
+    bool _expectControl = false;
+    bool _singleByte = false;
+    bool _data = false;
+    uint8_t _command[7] = {};
+    uint8_t _commandSize = 0;
+    uint8_t _commandLength = 0;
+
+    uint32_t _busBytes = 0;
+    uint32_t _frames = 0;
+    bool _changed = false;
+    uint64_t _changedAt = 0;
+    uint64_t _lastTransfer = 0;
+    Image _shown = {};
+    FrameCallback _callback;
+
+    static uint8_t getCommandLength(uint8_t command);
+    void command(uint8_t byte);
+    void execute();
+    void writeData(uint8_t byte);
+    Image render() const;
+};
@@ -0,0 +1,62 @@
+// The drivers bound to the I2c class and to the run time I2CInterface table through the adapter do
+// the same bus work: the same time is read and written with the same transactions and bytes.
+// The models only count register accesses, the cost of the indirect calls does not show here;
+// the flash cost of the two bindings is compared by the binding_size target, see README.md.
+
+#include "interrupts.hpp"
+#include "sim_test.hpp"
+
+using namespace sim_test;
+
+namespace {
+
+struct Result {
+    TimeStruct time;
+    TimeStruct written;
+    sim::I2cStats bus;
+};
+Result direct;
+Result adapter;
+
+// reads the chip, sets the time one hour ahead and reads it back
+template<typename Bus>
+Result exercise() {
+    sim::I2cStats before = sim::getI2cStats(Ds3231Model::ADDRESS);
+    DS3231<Bus> rtc(Ds3231Model::ADDRESS << 1);
+    rtc.init();
+    TimeStruct time = rtc.getTime();
+    rtc.setTime({static_cast<uint8_t>((time.hours + 1) % 24), time.minutes, time.seconds});
+    rtc.flush();
+    rtc.readData();
+    sim::I2cStats after = sim::getI2cStats(Ds3231Model::ADDRESS);
+    return {time, rtc.getTime(),
+            {after.transactions - before.transactions, after.bytesWritten - before.bytesWritten,
+             after.bytesRead - before.bytesRead, after.nacks - before.nacks}};
+}
+
+void firmware() {
+    Clocks::init();
+    SysTickMsTimer::init();
+    I2c1SDA::init();
+    I2c1SCL::init();
+    I2c1::init();
+    direct = exercise<I2c1>();
+    I2cInterfaceAdapter::instance = I2c1::getInterface();
+    adapter = exercise<I2cInterfaceAdapter>();
+}
+
+} // namespace
+
+int main() {
+    static Ds3231Model rtc(sim::Port::C, 7);
+    rtc.setDateTime({25, 3, 14, 10, 30, 0});
+    run(1000, []() {
+        SIM_CHECK(direct.time.hours == 10 && direct.written.hours == 11);
+        SIM_CHECK(adapter.time.hours == 11 && adapter.written.hours == 12);
+        SIM_CHECK(direct.bus.transactions > 0);
+        SIM_CHECK(direct.bus.transactions == adapter.bus.transactions);
+        SIM_CHECK(direct.bus.bytesWritten == adapter.bus.bytesWritten);
+        SIM_CHECK(direct.bus.bytesRead == adapter.bus.bytesRead);
+        SIM_CHECK(direct.bus.nacks == 0 && adapter.bus.nacks == 0);
+    }, firmware);
+}
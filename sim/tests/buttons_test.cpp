@@ -0,0 +1,136 @@
+// Buttons on bouncing contacts: the EXTI edges start the sampling, a press or release is queued
+// at most 20 ms after the contact settled, a 3 ms glitch gives no event, a held button gives its long
+// press and the repeats. Between the presses update() does not run, the former task polled every 5 ms.
+
+#include <vector>
+
+#include "interrupts.hpp"
+#include "sim_test.hpp"
+
+using namespace sim_test;
+
+namespace {
+
+constexpr uint32_t END_MS = 6000;
+
+struct Event {
+    uint8_t button;
+    ButtonEventType type;
+    uint32_t ms;
+};
+std::vector<Event> events;
+uint32_t updates = 0;
+volatile bool edge = false;
+
+// the buttons task of the clock: runs on an edge or when update() asked for it
+void firmware() {
+    Clocks::init();
+    SysTickMsTimer::init();
+    ButtonInput::init();
+    ButtonInput::setEdgeCallback([]() { edge = true; });
+    ButtonInput::setRepeat(PLUS_BUTTON, true);
+    bool timed = false;
+    uint32_t due = 0;
+    for(;;) {
+        uint32_t now = SysTickMsTimer::getTicks();
+        if(edge || (timed && static_cast<int32_t>(now - due) >= 0)) {
+            edge = false;
+            uint32_t next = ButtonInput::update();
+            updates++;
+            timed = next != 0;
+            due = now + next;
+            ButtonEvent event;
+            while(ButtonInput::takeEvent(event)) {
+                events.push_back({event.button, event.type, sim::nowMs()});
+            }
+            continue;
+        }
+        __disable_irq();
+        if(edge) {
+            __enable_irq();
+            continue;
+        }
+        SysTickMsTimer::idle(timed ? due - now : 1000);
+    }
+}
+
+// level changes of one pin in ms, starting with the contact closing
+void trace(sim::PinScript& input, uint8_t pin, std::initializer_list<uint32_t> changes) {
+    bool low = true;
+    for(uint32_t ms : changes) {
+        input.add(ms * sim::UNITS_PER_MS, sim::Port::C, pin, low);
+        low = !low;
+    }
+}
+
+const Event* find(uint8_t button, ButtonEventType type, uint32_t fromMs = 0) {
+    for(const Event& event : events) {
+        if(event.button == button && event.type == type && event.ms >= fromMs) {
+            return &event;
+        }
+    }
+    return nullptr;
+}
+
+uint32_t count(uint8_t button, ButtonEventType type) {
+    uint32_t n = 0;
+    for(const Event& event : events) {
+        n += event.button == button && event.type == type;
+    }
+    return n;
+}
+
+// 15 ms from the first sample at or after the first edge, less the part of a tick: the edges come on
+// whole milliseconds here, late in a SysTick tick
+bool within(const Event* event, uint32_t firstMs, uint32_t settledMs) {
+    return event != nullptr && event->ms >= firstMs + 14 && event->ms <= settledMs + 20;
+}
+
+} // namespace
+
+int main() {
+    static sim::PinScript input;
+    // Mode: 6 ms of bounce, held for 1.5 s, the release bounces for 3 ms
+    trace(input, MODE_PIN, {1000, 1001, 1002, 1004, 1006, 2500, 2501, 2503});
+    // Minus: a 3 ms glitch
+    trace(input, MINUS_PIN, {3000, 3003});
+    // Plus: a clean short press, then held for a second with repeats
+    trace(input, PLUS_PIN, {3500, 3560, 4000, 5000});
+
+    run(END_MS, []() {
+        const Event* modePress = find(MODE_BUTTON, ButtonEventType::press);
+        SIM_CHECK(within(modePress, 1000, 1006));
+        SIM_CHECK(within(find(MODE_BUTTON, ButtonEventType::release), 2500, 2503));
+        const Event* longPress = find(MODE_BUTTON, ButtonEventType::longPress);
+        SIM_CHECK(longPress != nullptr && modePress != nullptr
+                  && longPress->ms == modePress->ms + ButtonInput::LONG_PRESS_MS);
+        SIM_CHECK(count(MODE_BUTTON, ButtonEventType::press) == 1);
+        SIM_CHECK(count(MODE_BUTTON, ButtonEventType::release) == 1);
+
+        SIM_CHECK(count(MINUS_BUTTON, ButtonEventType::press) == 0);
+        SIM_CHECK(count(MINUS_BUTTON, ButtonEventType::release) == 0);
+
+        SIM_CHECK(within(find(PLUS_BUTTON, ButtonEventType::press), 3500, 3500));
+        SIM_CHECK(within(find(PLUS_BUTTON, ButtonEventType::release), 3560, 3560));
+        const Event* held = find(PLUS_BUTTON, ButtonEventType::press, 4000);
+        SIM_CHECK(within(held, 4000, 4000));
+        SIM_CHECK(within(find(PLUS_BUTTON, ButtonEventType::release, 5000), 5000, 5000));
+        // 10 per second after the delay, until the release is seen
+        const Event* firstRepeat = find(PLUS_BUTTON, ButtonEventType::repeat);
+        SIM_CHECK(firstRepeat != nullptr && held != nullptr
+                  && firstRepeat->ms == held->ms + ButtonInput::REPEAT_DELAY_MS);
+        SIM_CHECK(count(PLUS_BUTTON, ButtonEventType::repeat) == 6);
+        SIM_CHECK(count(PLUS_BUTTON, ButtonEventType::longPress) == 0);
+
+        SIM_CHECK(ButtonInput::getDroppedEvents() == 0);
+        SIM_CHECK(updates < END_MS / ButtonInput::SAMPLE_MS / 10);
+
+        std::printf("%u events, update() ran %u times in %u ms\n", static_cast<uint32_t>(events.size()), updates,
+                    END_MS);
+        if(verbose()) {
+            for(const Event& event : events) {
+                std::printf("%u ms: button %u event %u\n", event.ms, event.button, static_cast<unsigned>(event.type));
+            }
+        }
+    }, firmware);
+}
@@ -0,0 +1,56 @@
+// makeCharMap gives the same glyph index as the former linear search for every char: the clock font,
+// codes that are not in it, codes above 127 and a font with all printable ASCII characters.
+
+#include "sim_test.hpp"
+
+#include "ssd1306_font.hpp"
+
+using namespace sim_test;
+
+namespace {
+
+constexpr char CLOCK_CHARS[] = "0123456789.:D";
+constexpr uint8_t CLOCK_FALLBACK = 10;
+
+// getIndexOfChar before the table
+template<uint32_t N>
+uint8_t searchIndex(const char (&chars)[N], char c, uint8_t fallback) {
+    for(uint32_t i = 0; i + 1 < N; i++) {
+        if(chars[i] == c) {
+            return static_cast<uint8_t>(i);
+        }
+    }
+    return fallback;
+}
+
+struct Printable {
+    char chars[96] = {};
+
+    constexpr Printable() {
+        for(uint8_t i = 0; i < 95; i++) {
+            chars[i] = static_cast<char>(' ' + i);
+        }
+    }
+};
+constexpr Printable PRINTABLE;
+
+} // namespace
+
+int main() {
+    constexpr SSD1306CharMap clockMap = makeCharMap(CLOCK_CHARS, CLOCK_FALLBACK);
+    constexpr SSD1306CharMap asciiMap = makeCharMap(PRINTABLE.chars, 0);
+    static_assert(clockMap['7'] == 7 && clockMap[':'] == 11, "the table is built at compile time");
+
+    for(int code = -128; code < 128; code++) {
+        char c = static_cast<char>(code);
+        uint8_t expected = searchIndex(CLOCK_CHARS, c, CLOCK_FALLBACK);
+        uint8_t expectedAscii = searchIndex(PRINTABLE.chars, c, 0);
+        if(clockMap[c] != expected || asciiMap[c] != expectedAscii) {
+            std::fprintf(stderr, "code %d\n", code);
+        }
+        SIM_CHECK(clockMap[c] == expected);
+        SIM_CHECK(asciiMap[c] == expectedAscii);
+    }
+    SIM_CHECK(asciiMap['~'] == 94);
+    return report();
+}
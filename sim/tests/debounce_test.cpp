@@ -0,0 +1,98 @@
+// VerticalDebounce against a counter per input: 32 inputs on random bounce and noise traces give the
+// same toggles, states and masks for every sample, and a glitch of up to three samples never toggles.
+
+#include "sim_test.hpp"
+
+#include "buttons.hpp"
+
+using namespace sim_test;
+
+namespace {
+
+constexpr uint32_t SAMPLES = 200000;
+
+// one input: the state changes after SAMPLES samples in a row that differ from it
+struct Reference {
+    bool state = false;
+    uint8_t differing = 0;
+
+    bool update(bool sample) {
+        if(sample == state) {
+            differing = 0;
+            return false;
+        }
+        if(++differing < VerticalDebounce::SAMPLES) {
+            return false;
+        }
+        state = sample;
+        differing = 0;
+        return true;
+    }
+};
+
+uint32_t seed = 1;
+
+uint32_t nextRandom() {
+    seed = seed * 1103515245 + 12345;
+    return seed >> 8;
+}
+
+} // namespace
+
+int main() {
+    // the contacts: each input flips with its own rate, some of them bounce, some see single-sample noise
+    VerticalDebounce debounce;
+    Reference reference[32];
+    uint32_t levels = 0;
+    uint32_t toggles = 0;
+    uint32_t mismatches = 0;
+    for(uint32_t i = 0; i < SAMPLES; i++) {
+        for(uint8_t bit = 0; bit < 32; bit++) {
+            if(nextRandom() % (8 + bit * 4) == 0) {
+                levels ^= 1UL << bit;
+            }
+        }
+        uint32_t noise = (nextRandom() % 4 == 0) ? 1UL << (nextRandom() % 32) : 0;
+        uint32_t sample = levels ^ noise;
+
+        uint32_t toggle = debounce.update(sample);
+        uint32_t expectedToggle = 0;
+        uint32_t expectedState = 0;
+        for(uint8_t bit = 0; bit < 32; bit++) {
+            if(reference[bit].update((sample >> bit) & 1)) {
+                expectedToggle |= 1UL << bit;
+            }
+            expectedState |= static_cast<uint32_t>(reference[bit].state) << bit;
+        }
+        bool same = toggle == expectedToggle && debounce.getHeld() == expectedState
+            && debounce.getPressed() == (expectedToggle & expectedState)
+            && debounce.getReleased() == (expectedToggle & ~expectedState)
+            && debounce.getPending(sample) == (sample ^ expectedState);
+        if(!same && mismatches++ < 5) {
+            std::fprintf(stderr, "sample %u: toggle %08x, expected %08x\n", i, toggle, expectedToggle);
+        }
+        toggles += __builtin_popcount(expectedToggle);
+    }
+    std::printf("%u samples, %u toggles\n", SAMPLES, toggles);
+    SIM_CHECK(mismatches == 0);
+    SIM_CHECK(toggles > SAMPLES / 10);
+
+    // glitches of 1 to 3 samples from both states, on every input at once, with the state sample between
+    for(uint32_t state : {0UL, 0xFFFFFFFFUL}) {
+        VerticalDebounce settled(state);
+        for(uint8_t length = 1; length < VerticalDebounce::SAMPLES; length++) {
+            for(uint8_t i = 0; i < length; i++) {
+                SIM_CHECK(settled.update(~state) == 0);
+            }
+            SIM_CHECK(settled.update(state) == 0);
+        }
+        SIM_CHECK(settled.getHeld() == state);
+        // the fourth sample does toggle
+        for(uint8_t i = 0; i + 1 < VerticalDebounce::SAMPLES; i++) {
+            settled.update(~state);
+        }
+        SIM_CHECK(settled.update(~state) == 0xFFFFFFFF);
+        SIM_CHECK(settled.getHeld() == ~state);
+    }
+    return report();
+}
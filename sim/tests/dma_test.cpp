@@ -0,0 +1,67 @@
+// updateScreen() hands the frame to the DMA and returns: the CPU sleeps through the transfer, a few
+// interrupts end the transactions instead of one per byte, and the panel shows the buffer.
+
+#include "interrupts.hpp"
+#include "sim_test.hpp"
+
+using namespace sim_test;
+
+namespace {
+
+using Display = SSD1306<I2c1>;
+uint8_t buffer[Display::BUFFER_SIZE];
+
+bool startedInBackground = false;
+uint64_t transferUnits = 0;
+uint64_t sleepUnits = 0;
+uint32_t transferInterrupts = 0;
+
+void firmware() {
+    Clocks::init();
+    SysTickMsTimer::init();
+    I2c1SDA::init();
+    I2c1SCL::init();
+    I2c1::init();
+    static Display display(0x3C << 1, buffer);
+    display.init();
+    // every byte differs from its neighbours
+    for(uint32_t i = 0; i < Display::WIDTH * Display::PAGES; i++) {
+        buffer[i] = static_cast<uint8_t>(i * 7 + i / Display::WIDTH);
+    }
+    display.invalidate();
+
+    uint64_t start = sim::now();
+    uint64_t sleep = sim::getResidency().sleep;
+    uint32_t interrupts = sim::getInterruptCount();
+    display.updateScreen();
+    startedInBackground = display.isUpdating();
+    display.waitForUpdate();
+    transferUnits = sim::now() - start;
+    sleepUnits = sim::getResidency().sleep - sleep;
+    transferInterrupts = sim::getInterruptCount() - interrupts;
+    // lets the panel model settle on the new picture
+    SysTickMsTimer::delayMs(5);
+}
+
+} // namespace
+
+int main() {
+    static Ssd1306Model display;
+    run(1000, []() {
+        SIM_CHECK(startedInBackground);
+        // 1024 bytes at 400 kHz take more than 20 ms
+        SIM_CHECK(transferUnits > 20 * sim::UNITS_PER_MS);
+        SIM_CHECK(sleepUnits > transferUnits * 9 / 10);
+        // the SysTick and the end of the transaction
+        SIM_CHECK(transferInterrupts < 64);
+        const Ssd1306Model::Image& image = display.getImage();
+        bool same = true;
+        for(uint8_t y = 0; y < Ssd1306Model::HEIGHT; y++) {
+            for(uint8_t x = 0; x < Ssd1306Model::WIDTH; x++) {
+                bool lit = (buffer[(y / 8) * Display::WIDTH + x] >> (y % 8)) & 1;
+                same &= lit == isLit(image, x, y);
+            }
+        }
+        SIM_CHECK(same);
+    }, firmware);
+}
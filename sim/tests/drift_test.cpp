@@ -0,0 +1,145 @@
+// DS3231Clock drift against the chip model: local ticks 1 % fast and 1 % slow, counted alone or
+// corrected by the falling edges of the square wave. The resync after ten minutes reports local minus
+// chip time: about +6 s for the fast tick and -6 s for the slow one, to the second without the edges
+// and to the millisecond with them. Without the edges the local time and the chip time are on either
+// side of midnight on New Year's Eve at the resync, the edge clocks roll the date over themselves.
+
+#include "interrupts.hpp"
+#include "sim_test.hpp"
+
+using namespace sim_test;
+
+namespace {
+
+// the SysTick milliseconds scaled by num / den, a local oscillator that is off
+template<uint32_t num, uint32_t den>
+struct ScaledTicks {
+    static uint32_t getTicks() {
+        return static_cast<uint32_t>(static_cast<uint64_t>(SysTickMsTimer::getTicks()) * num / den);
+    }
+};
+using FastTicks = ScaledTicks<101, 100>;
+using SlowTicks = ScaledTicks<99, 100>;
+
+constexpr uint32_t RESYNC_SECONDS = 600;
+constexpr uint32_t END_MS = 700000;
+
+struct Result {
+    int32_t drift;
+    uint32_t interval;
+    DateStruct date;
+    TimeStruct time;
+};
+Result fast;
+Result slow;
+Result fastEdges;
+Result slowEdges;
+DateStruct finalDates[4];
+
+template<typename Clock>
+bool take(Clock& clock, Result& result) {
+    if(result.interval != 0 || clock.getDriftInterval() == 0) {
+        return result.interval != 0;
+    }
+    result = {clock.getDrift(), clock.getDriftInterval(), clock.getDate(), clock.getTime()};
+    return true;
+}
+
+void firmware() {
+    Clocks::init();
+    SysTickMsTimer::init();
+    I2c1SDA::init();
+    I2c1SCL::init();
+    I2c1::init();
+    static Rtc rtc(Ds3231Model::ADDRESS << 1);
+    rtc.init();
+    rtc.enableSquareWave1Hz();
+    RtcSqwPin::init();
+    static DS3231Clock<Rtc, FastTicks> fastClock(rtc);
+    static DS3231Clock<Rtc, SlowTicks> slowClock(rtc);
+    static DS3231Clock<Rtc, FastTicks> fastEdgeClock(rtc);
+    static DS3231Clock<Rtc, SlowTicks> slowEdgeClock(rtc);
+    // at 23:49:57 the slow clock gets to 23:59:57 when the chip is past midnight
+    slowClock.resync();
+    SysTickMsTimer::delayMs(3000);
+    // the fast one gets to midnight when the chip is not yet there
+    fastClock.resync();
+    SysTickMsTimer::delayMs(2000);
+    // the resync comes two seconds after midnight
+    fastEdgeClock.resync();
+    slowEdgeClock.resync();
+
+    bool sqw = RtcSqwPin::read();
+    while(sim::nowMs() < END_MS) {
+        SysTickMsTimer::delayMs(1);
+        fastClock.update();
+        slowClock.update();
+        bool level = RtcSqwPin::read();
+        if(sqw && !level) {
+            fastEdgeClock.secondEdge();
+            slowEdgeClock.secondEdge();
+        } else {
+            fastEdgeClock.update();
+            slowEdgeClock.update();
+        }
+        sqw = level;
+        bool done = take(fastClock, fast);
+        done &= take(slowClock, slow);
+        done &= take(fastEdgeClock, fastEdges);
+        done &= take(slowEdgeClock, slowEdges);
+        if(done) {
+            break;
+        }
+    }
+    finalDates[0] = fastClock.getDate();
+    finalDates[1] = slowClock.getDate();
+    finalDates[2] = fastEdgeClock.getDate();
+    finalDates[3] = slowEdgeClock.getDate();
+}
+
+bool isNewYear(const DateStruct& date) {
+    return date.date == 1 && date.month == 1 && date.year == 26;
+}
+
+// the resync took the chip time over, chipSeconds from midnight
+bool resynced(const Result& result, int32_t chipSeconds) {
+    int32_t seconds = result.time.hours * 3600 + result.time.minutes * 60 + result.time.seconds;
+    if(result.time.hours == 23) {
+        seconds -= 24 * 3600;
+    }
+    bool date = chipSeconds < 0 ? result.date.date == 31 && result.date.month == 12 && result.date.year == 25
+                                : isNewYear(result.date);
+    return result.interval == RESYNC_SECONDS && date && seconds >= chipSeconds - 1 && seconds <= chipSeconds + 1;
+}
+
+bool within(int32_t value, int32_t expected, int32_t tolerance) {
+    return value >= expected - tolerance && value <= expected + tolerance;
+}
+
+} // namespace
+
+int main() {
+    static Ds3231Model rtc(sim::Port::C, 7);
+    rtc.setDateTime({25, 12, 31, 23, 49, 57});
+    run(END_MS + 1000, []() {
+        for(const DateStruct& date : finalDates) {
+            SIM_CHECK(isNewYear(date));
+        }
+        // 600 local seconds are 594 or 606 chip seconds, the count alone is off by up to a second
+        SIM_CHECK(resynced(fast, -6));
+        SIM_CHECK(resynced(slow, 3));
+        // the edges keep the local seconds on the chip's
+        SIM_CHECK(resynced(fastEdges, 2));
+        SIM_CHECK(resynced(slowEdges, 2));
+        SIM_CHECK(within(fast.drift, 6000, 1000) && fast.drift % 1000 == 0);
+        SIM_CHECK(within(slow.drift, -6000, 1000) && slow.drift % 1000 == 0);
+        // 10 ms early or late at every edge
+        SIM_CHECK(within(fastEdges.drift, 6000, 20));
+        SIM_CHECK(within(slowEdges.drift, -6000, 20));
+        if(failures != 0) {
+            for(const Result* result : {&fast, &slow, &fastEdges, &slowEdges}) {
+                std::fprintf(stderr, "drift %d ms over %u s\n", result->drift, result->interval);
+            }
+        }
+    }, firmware);
+}
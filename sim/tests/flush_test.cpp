@@ -0,0 +1,106 @@
+// flush() writes one transaction per run of changed registers and nothing when setTime()/setDate()
+// changed no register. Clearing OSF writes back the status the chip has at that moment: an alarm
+// flag set after the registers were read stays set, the control register is not written. writeData()
+// sent all 19 registers every time.
+
+#include "interrupts.hpp"
+#include "sim_test.hpp"
+
+using namespace sim_test;
+
+namespace {
+
+constexpr uint8_t STATUS = 0x0F;
+constexpr uint8_t CONTROL = 0x0E;
+constexpr uint8_t STATUS_OSF = 0x80;
+constexpr uint8_t STATUS_A1F = 0x01;
+
+Ds3231Model* model = nullptr;
+
+struct Cost {
+    uint32_t transactions;
+    uint32_t bytesWritten;
+};
+Cost sameTime;
+Cost minutes;
+Cost wholeTime;
+Cost dateAndYear;
+Cost writeAll;
+bool dirtyAfterSameTime = true;
+
+const sim::I2cStats& stats() {
+    return sim::getI2cStats(Ds3231Model::ADDRESS);
+}
+
+template<typename Change>
+Cost measure(Change change) {
+    uint32_t transactions = stats().transactions;
+    uint32_t bytes = stats().bytesWritten;
+    change();
+    return {stats().transactions - transactions, stats().bytesWritten - bytes};
+}
+
+void firmware() {
+    Clocks::init();
+    SysTickMsTimer::init();
+    I2c1SDA::init();
+    I2c1SCL::init();
+    I2c1::init();
+    static DS3231<I2c1> rtc(Ds3231Model::ADDRESS << 1);
+    rtc.init();
+    // the alarm fires after init() read the status
+    model->setStatusFlags(STATUS_A1F);
+
+    // also clears OSF, a status read and a status write
+    minutes = measure([]() {
+        rtc.setTime({12, 35, 56});
+        rtc.flush();
+    });
+    sameTime = measure([]() {
+        rtc.setDate({14, 3, 25});
+        dirtyAfterSameTime = rtc.isDirty();
+        rtc.flush();
+    });
+    wholeTime = measure([]() {
+        rtc.setTime({13, 0, 0});
+        rtc.flush();
+    });
+    // the month stays, the date and the year are two runs
+    dateAndYear = measure([]() {
+        rtc.setDate({15, 3, 26});
+        rtc.flush();
+    });
+    writeAll = measure([]() {
+        rtc.writeData();
+    });
+}
+
+} // namespace
+
+int main() {
+    static Ds3231Model rtc(sim::Port::C, 7);
+    model = &rtc;
+    rtc.setDateTime({25, 3, 14, 12, 34, 56});
+    rtc.setStatusFlags(STATUS_OSF);
+    run(1000, []() {
+        // register pointer and minutes, pointer for the status read, the read, pointer and status
+        SIM_CHECK(minutes.transactions == 4 && minutes.bytesWritten == 5);
+        SIM_CHECK(!dirtyAfterSameTime);
+        SIM_CHECK(sameTime.transactions == 0);
+        SIM_CHECK(wholeTime.transactions == 1 && wholeTime.bytesWritten == 4);
+        SIM_CHECK(dateAndYear.transactions == 2 && dateAndYear.bytesWritten == 4);
+        SIM_CHECK(writeAll.transactions == 1 && writeAll.bytesWritten == 1 + DS3231<I2c1>::DATA_SIZE);
+
+        Ds3231Model::DateTime now = rtc.getDateTime();
+        SIM_CHECK(now.hours == 13 && now.minutes == 0 && now.date == 15 && now.month == 3 && now.year == 26);
+        SIM_CHECK((rtc.getRegister(STATUS) & STATUS_OSF) == 0);
+        SIM_CHECK((rtc.getRegister(STATUS) & STATUS_A1F) != 0);
+        // set by init()
+        SIM_CHECK(rtc.getRegister(CONTROL) == 0x04);
+
+        std::printf("transactions/bytes written: minutes + OSF %u/%u, same date %u/%u, whole time %u/%u, "
+                    "date and year %u/%u, writeData() %u/%u\n", minutes.transactions, minutes.bytesWritten,
+                    sameTime.transactions, sameTime.bytesWritten, wholeTime.transactions, wholeTime.bytesWritten,
+                    dateAndYear.transactions, dateAndYear.bytesWritten, writeAll.transactions, writeAll.bytesWritten);
+    }, firmware);
+}
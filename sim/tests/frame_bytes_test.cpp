@@ -0,0 +1,65 @@
+// The frame buffer renderer sends only the changed columns of each page. In the normal screen a new
+// second changes one or two digits, a frame costs a few dozen bus bytes instead of the full 1037.
+// Page streaming skips the pages that render the same as before and sends the two pages of the time
+// row, 270 bytes instead of 1044.
+
+#include <vector>
+
+#include "main.hpp"
+#include "sim_test.hpp"
+
+using namespace sim_test;
+
+namespace {
+
+struct Sent {
+    uint64_t time;
+    uint32_t busBytes;
+    std::string clock;
+};
+std::vector<Sent> sent;
+
+// 1024 bytes of the frame, the window commands and the data control byte
+constexpr uint32_t FULL_FRAME_BYTES = 1037;
+// the seconds digits, the colons next to them are not sent again, or the window and two whole pages
+constexpr uint32_t SECOND_BYTES = OLED_PAGE_STREAMING ? 13 + 2 * 128 + 1 : 64;
+
+} // namespace
+
+int main() {
+    static Ds3231Model rtc(sim::Port::C, 7);
+    static Ssd1306Model display;
+    rtc.setDateTime({25, 3, 14, 12, 59, 50});
+    display.setFrameCallback([](const Ssd1306Model::Frame& frame) {
+        sent.push_back({frame.time, frame.busBytes, readTime(frame.image)});
+    });
+
+    run(12000, []() {
+        // the first frame after start up, then one per second up to 13:00:01
+        SIM_CHECK(sent.size() == 12);
+        if(sent.size() != 12) {
+            return;
+        }
+        SIM_CHECK(sent[0].clock == "12:59:50");
+        SIM_CHECK(sent[0].busBytes >= FULL_FRAME_BYTES);
+        uint32_t total = 0;
+        for(size_t i = 1; i < sent.size(); i++) {
+            total += sent[i].busBytes;
+            if(sent[i].clock != "13:00:00") {
+                SIM_CHECK(sent[i].busBytes <= SECOND_BYTES);
+            }
+        }
+        // all six time digits change
+        SIM_CHECK(sent[10].clock == "13:00:00"
+                  && sent[10].busBytes <= (OLED_PAGE_STREAMING ? SECOND_BYTES : FULL_FRAME_BYTES / 4));
+        SIM_CHECK(total / (sent.size() - 1) < (OLED_PAGE_STREAMING ? FULL_FRAME_BYTES / 3 : FULL_FRAME_BYTES / 10));
+
+        std::printf("%u bytes for the first frame, %u per second on average, %u at 13:00:00\n", sent[0].busBytes,
+                    static_cast<uint32_t>(total / (sent.size() - 1)), sent[10].busBytes);
+        if(verbose()) {
+            for(const Sent& frame : sent) {
+                std::printf("%s: %u bytes\n", frame.clock.c_str(), frame.busBytes);
+            }
+        }
+    });
+}
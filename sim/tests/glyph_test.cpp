@@ -0,0 +1,89 @@
+// The glyph tables built at compile time draw the same pixels as the former drawPixel loops: the
+// 16x16 digits against every source pixel drawn as a 2x2 block, the 8x8 digits against the source
+// pixels, at page aligned and unaligned positions, clipped at the right and the bottom edge and over
+// a random background.
+
+#include <cstring>
+
+#include "main.hpp"
+#include "sim_test.hpp"
+
+using namespace sim_test;
+
+namespace {
+
+using Display = SSD1306<I2c1>;
+constexpr uint32_t FRAME_SIZE = Display::WIDTH * Display::PAGES;
+
+constexpr auto digits8x8 = transposeFont8x8(DIGITS);
+constexpr auto digits16x16 = scaleFont16x16(DIGITS);
+
+struct Screen {
+    uint8_t buffer[Display::BUFFER_SIZE] = {};
+    Display display{0x3C << 1, buffer};
+
+    explicit Screen(uint32_t seed) {
+        for(uint32_t i = 0; i < FRAME_SIZE; i++) {
+            seed = seed * 1103515245 + 12345;
+            buffer[i] = static_cast<uint8_t>(seed >> 16);
+        }
+    }
+};
+
+// drawChar16x16 before the glyph tables
+void drawPixels16x16(Display& display, uint8_t x, uint8_t y, const uint8_t (&rows)[8]) {
+    for(uint8_t i = 0; i < 8; i++) {
+        for(uint8_t j = 0; j < 8; j++) {
+            bool lit = rows[i] & (1 << (7 - j));
+            display.drawPixel(x + 2 * j, y + 2 * i, lit);
+            display.drawPixel(x + 2 * j + 1, y + 2 * i, lit);
+            display.drawPixel(x + 2 * j, y + 2 * i + 1, lit);
+            display.drawPixel(x + 2 * j + 1, y + 2 * i + 1, lit);
+        }
+    }
+}
+
+// drawChar8x8 before the glyph tables
+void drawPixels8x8(Display& display, uint8_t x, uint8_t y, const uint8_t (&rows)[8]) {
+    for(uint8_t i = 0; i < 8; i++) {
+        for(uint8_t j = 0; j < 8; j++) {
+            display.drawPixel(x + j, y + i, rows[i] & (1 << (7 - j)));
+        }
+    }
+}
+
+constexpr uint8_t XS[] = {0, 10, 50, 112, 120};
+constexpr uint8_t YS[] = {0, 1, 7, 8, 39, 40, 48, 50, 57, 60};
+
+bool compare(const Screen& reference, const Screen& tested, const char* glyph, uint8_t digit, uint8_t x, uint8_t y) {
+    bool same = std::memcmp(reference.buffer, tested.buffer, FRAME_SIZE) == 0;
+    if(!same) {
+        std::fprintf(stderr, "%s digit %u at %u,%u\n", glyph, digit, x, y);
+    }
+    return same;
+}
+
+} // namespace
+
+int main() {
+    uint32_t seed = 1;
+    for(uint8_t digit = 0; digit < 10; digit++) {
+        for(uint8_t x : XS) {
+            for(uint8_t y : YS) {
+                Screen reference(seed);
+                Screen tested(seed);
+                drawPixels16x16(reference.display, x, y, DIGITS[digit]);
+                tested.display.drawGlyph(x, y, digits16x16[digit]);
+                SIM_CHECK(compare(reference, tested, "16x16", digit, x, y));
+
+                Screen reference8x8(seed);
+                Screen tested8x8(seed);
+                drawPixels8x8(reference8x8.display, x, y, DIGITS[digit]);
+                tested8x8.display.drawGlyph(x, y, digits8x8[digit]);
+                SIM_CHECK(compare(reference8x8, tested8x8, "8x8", digit, x, y));
+                seed++;
+            }
+        }
+    }
+    return report();
+}
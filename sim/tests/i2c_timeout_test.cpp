@@ -0,0 +1,165 @@
+// A device that holds SCL low stops every transfer: a queued transaction is aborted at its deadline
+// with ERROR_TIMEOUT to its callback, a blocking call waiting behind it returns at its own timeout,
+// waitForUpdate() returns and the frame is sent again once the bus is free. Empty transactions are
+// refused by submit().
+
+#include "interrupts.hpp"
+#include "sim_test.hpp"
+
+using namespace sim_test;
+
+namespace {
+
+using Display = SSD1306<I2c1>;
+uint8_t buffer[Display::BUFFER_SIZE];
+
+constexpr uint8_t RTC = Ds3231Model::ADDRESS << 1;
+constexpr uint8_t SECONDS = 0x00;
+
+struct Async {
+    bool called;
+    uint32_t error;
+    uint64_t at;
+};
+Async stalledWrite;
+Async freeRead;
+
+struct Blocking {
+    uint32_t error;
+    uint64_t units;
+};
+Blocking behindQueue;
+Blocking afterAbort;
+Blocking freeBlocking;
+
+uint64_t submittedAt = 0;
+uint64_t updateUnits = 0;
+bool updatingAfterAbort = true;
+bool acknowledged = true;
+uint64_t pollingUnits = 0;
+bool busyAfterAbort = true;
+bool emptyRead = true;
+bool emptySegments = true;
+bool noSegments = true;
+bool busyAfterEmpty = true;
+uint8_t writeData[2] = {0x00, 0x01};
+uint8_t freeSeconds = 0xFF;
+uint8_t asyncSeconds = 0xFF;
+
+void record(void* context, uint32_t error) {
+    Async* async = static_cast<Async*>(context);
+    *async = {true, error, sim::now()};
+}
+
+template<typename Call>
+Blocking measure(Call call) {
+    uint64_t start = sim::now();
+    call();
+    return {I2c1::errorCode, sim::now() - start};
+}
+
+void firmware() {
+    Clocks::init();
+    SysTickMsTimer::init();
+    I2c1SDA::init();
+    I2c1SCL::init();
+    I2c1::init();
+    static Display display(0x3C << 1, buffer);
+    display.init();
+    SysTickMsTimer::delayMs(1);
+
+    sim::stallI2c(true);
+    // a deadline of 10 ms for the two bytes, a blocking call with a shorter timeout gives up first
+    submittedAt = sim::now();
+    I2c1::submit(I2cTransaction::write(RTC, 0x07, I2cMemAddrSize::oneByte, writeData, sizeof(writeData),
+                                       record, &stalledWrite));
+    uint8_t seconds;
+    behindQueue = measure([&]() {
+        I2c1::memoryRead(RTC, SECONDS, I2cMemAddrSize::oneByte, &seconds, 1, 5);
+    });
+    // the wait aborts the queued write, then the blocking transfer itself times out
+    afterAbort = measure([&]() {
+        I2c1::memoryRead(RTC, SECONDS, I2cMemAddrSize::oneByte, &seconds, 1, 30);
+    });
+    busyAfterAbort = I2c1::isBusy();
+    uint64_t start = sim::now();
+    acknowledged = I2c1::acknowledgePolling(RTC, 5);
+    pollingUnits = sim::now() - start;
+
+    for(uint32_t i = 0; i < Display::WIDTH * Display::PAGES; i++) {
+        buffer[i] = static_cast<uint8_t>(i * 3 + i / Display::WIDTH);
+    }
+    display.invalidate();
+    start = sim::now();
+    display.updateScreen();
+    display.waitForUpdate();
+    updateUnits = sim::now() - start;
+    updatingAfterAbort = display.isUpdating();
+
+    sim::stallI2c(false);
+    freeBlocking = measure([&]() {
+        I2c1::memoryRead(RTC, SECONDS, I2cMemAddrSize::oneByte, &freeSeconds, 1, 10);
+    });
+    I2c1::submit(I2cTransaction::read(RTC, SECONDS, I2cMemAddrSize::oneByte, &asyncSeconds, 1, record, &freeRead));
+    // the frame is still dirty from the aborted transfer
+    display.updateScreen();
+    display.waitForUpdate();
+
+    emptyRead = I2c1::submit(I2cTransaction::read(RTC, SECONDS, I2cMemAddrSize::oneByte, &seconds, 0));
+    static const I2cSegment empty[2] = {{writeData, 0}, {nullptr, 0}};
+    emptySegments = I2c1::submit(I2cTransaction::writeSegments(RTC, empty, 2));
+    noSegments = I2c1::submit(I2cTransaction::writeSegments(RTC, empty, 0));
+    busyAfterEmpty = I2c1::isBusy();
+    SysTickMsTimer::delayMs(5);
+}
+
+uint32_t toMs(uint64_t units) {
+    return static_cast<uint32_t>(units / sim::UNITS_PER_MS);
+}
+
+// the timeouts count whole ticks from the one the call started in
+bool within(uint64_t units, uint32_t timeoutMs) {
+    return toMs(units) + 1 >= timeoutMs && toMs(units) <= timeoutMs;
+}
+
+} // namespace
+
+int main() {
+    static Ds3231Model rtc(sim::Port::C, 7);
+    static Ssd1306Model display;
+    rtc.setDateTime({25, 3, 14, 12, 34, 56});
+    run(1000, []() {
+        using Error = I2c1::ErrorCodes;
+        SIM_CHECK(behindQueue.error == Error::ERROR_TIMEOUT);
+        SIM_CHECK(within(behindQueue.units, 5));
+
+        SIM_CHECK(stalledWrite.called && stalledWrite.error == Error::ERROR_TIMEOUT);
+        uint32_t abortMs = toMs(stalledWrite.at - submittedAt);
+        SIM_CHECK(abortMs >= 9 && abortMs <= 10);
+        SIM_CHECK(afterAbort.error == Error::ERROR_TIMEOUT);
+        SIM_CHECK(within(afterAbort.units, 30));
+        SIM_CHECK(!busyAfterAbort);
+        SIM_CHECK(!acknowledged);
+        SIM_CHECK(within(pollingUnits, 5));
+
+        // one window for the whole frame, aborted at its deadline
+        SIM_CHECK(!updatingAfterAbort);
+        SIM_CHECK(within(updateUnits, 10 + 1037 / 8));
+
+        SIM_CHECK(freeBlocking.error == Error::ERROR_NONE && freeSeconds == 0x56);
+        SIM_CHECK(freeRead.called && freeRead.error == Error::ERROR_NONE && asyncSeconds == 0x56);
+        const Ssd1306Model::Image& image = display.getImage();
+        bool same = true;
+        for(uint8_t y = 0; y < Ssd1306Model::HEIGHT; y++) {
+            for(uint8_t x = 0; x < Ssd1306Model::WIDTH; x++) {
+                bool lit = (buffer[(y / 8) * Display::WIDTH + x] >> (y % 8)) & 1;
+                same &= lit == isLit(image, x, y);
+            }
+        }
+        SIM_CHECK(same);
+
+        SIM_CHECK(!emptyRead && !emptySegments && !noSegments && !busyAfterEmpty);
+        // the stalled write never reached the chip
+        SIM_CHECK(rtc.getRegister(0x07) == 0x00);
+    }, firmware);
+}
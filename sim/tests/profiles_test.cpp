@@ -0,0 +1,141 @@
+// Every clock profile on the models: the I2C registers hold the bus timing computed for its clock, a
+// DS3231 read runs at no more than 400 kHz, SysTick counts 1 ms per millisecond, and switching back
+// and forth loses no tick. The clocks of all HSI and PLL prescalers are checked the way the profile
+// static_asserts check them.
+
+#include <algorithm>
+
+#include "interrupts.hpp"
+#include "sim_test.hpp"
+
+using namespace sim_test;
+
+namespace {
+
+constexpr uint32_t FAST_SPEED = 400000;
+constexpr uint32_t TICK_TEST_MS = 500;
+
+struct Measured {
+    uint32_t ahbClock;
+    bool selected;
+    uint16_t frequency;
+    uint16_t clockConfig;
+    uint32_t busSpeed;
+    uint64_t readUnits;
+    uint32_t ticks;
+    uint64_t tickUnits;
+};
+Measured measured[Clocks::COUNT];
+uint32_t switchTicks = 0;
+uint64_t switchUnits = 0;
+
+// the register pointer write and the 19 byte read, 9 clocks per byte and the START, repeated START and STOP
+constexpr uint32_t READ_BITS = (2 + 1 + DS3231<I2c1>::DATA_SIZE) * 9 + 3;
+
+void firmware() {
+    Clocks::init();
+    SysTickMsTimer::init();
+    I2c1SDA::init();
+    I2c1SCL::init();
+    I2c1::init();
+
+    for(uint8_t profile = 0; profile < Clocks::COUNT; profile++) {
+        Measured& m = measured[profile];
+        m.selected = Clocks::select(profile) && Clocks::getProfile() == profile;
+        m.ahbClock = Clocks::getAHBClock();
+        m.frequency = I2C1->CTLR2 & I2C_CTLR2_FREQ;
+        m.clockConfig = I2C1->CKCFGR;
+        m.busSpeed = I2c1::getBusSpeed(m.ahbClock);
+
+        uint8_t registers[DS3231<I2c1>::DATA_SIZE];
+        uint64_t start = sim::now();
+        I2c1::memoryRead(Ds3231Model::ADDRESS << 1, 0x00, I2cMemAddrSize::oneByte, registers, sizeof(registers), 10);
+        m.readUnits = sim::now() - start;
+
+        // from the start of a tick
+        SysTickMsTimer::delayMs(1);
+        uint32_t ticks = SysTickMsTimer::getTicks();
+        start = sim::now();
+        SysTickMsTimer::delayMs(TICK_TEST_MS);
+        m.ticks = SysTickMsTimer::getTicks() - ticks;
+        m.tickUnits = sim::now() - start;
+    }
+
+    // the switches rescale the running millisecond
+    SysTickMsTimer::delayMs(1);
+    uint32_t ticks = SysTickMsTimer::getTicks();
+    uint64_t start = sim::now();
+    for(uint32_t i = 0; i < 50; i++) {
+        Clocks::select(IDLE_CLOCK);
+        SysTickMsTimer::delayMs(3);
+        Clocks::select(RUN_CLOCK);
+        SysTickMsTimer::delayMs(4);
+    }
+    switchTicks = SysTickMsTimer::getTicks() - ticks;
+    switchUnits = sim::now() - start;
+}
+
+// HCLK of HSI and PLL with every AHB prescaler
+constexpr uint32_t PRESCALERS[] = {1, 2, 3, 4, 5, 6, 7, 8, 16, 32, 64, 128, 256};
+constexpr uint32_t SOURCES[] = {24000000, 48000000};
+
+void checkAllClocks() {
+    uint32_t profiles = 0;
+    for(uint32_t source : SOURCES) {
+        for(uint32_t prescaler : PRESCALERS) {
+            uint32_t clock = source / prescaler;
+            bool valid = I2c1::isClockValid(clock);
+            // fast mode with 2:1 duty works from 4 MHz on, CCR is rounded up
+            SIM_CHECK(valid == (clock >= 4000000));
+            if(valid) {
+                SIM_CHECK(I2c1::getBusSpeed(clock) <= FAST_SPEED);
+            }
+            bool exactTick = SysTickMsTimer::countsPerMs(clock) * 1000 * 8 == clock;
+            profiles += valid && exactTick;
+        }
+    }
+    // HSI 24, 12, 8, 6, 4.8 and 4 MHz, PLL 48, 24, 16, 12, 9.6, 8 and 6 MHz
+    SIM_CHECK(profiles == 13);
+}
+
+} // namespace
+
+int main() {
+    checkAllClocks();
+    static Ds3231Model rtc(sim::Port::C, 7);
+    run(5000, []() {
+        uint32_t slowest = FAST_SPEED;
+        for(uint8_t profile = 0; profile < Clocks::COUNT; profile++) {
+            const Measured& m = measured[profile];
+            uint32_t measuredSpeed = static_cast<uint32_t>(READ_BITS * sim::UNITS_PER_SECOND / m.readUnits);
+            slowest = std::min(slowest, measuredSpeed);
+            SIM_CHECK(m.selected);
+            // the I2C peripheral runs on 4 to 48 MHz and has to know its clock
+            SIM_CHECK(m.ahbClock >= 4000000 && m.ahbClock <= 48000000);
+            SIM_CHECK(m.frequency == m.ahbClock / 1000000);
+            SIM_CHECK(m.clockConfig == I2c1::getClockConfig(m.ahbClock));
+            SIM_CHECK(m.busSpeed <= FAST_SPEED && m.busSpeed > FAST_SPEED * 9 / 10);
+            // the bus model clocks the bytes from CKCFGR and the core clock
+            SIM_CHECK(measuredSpeed <= FAST_SPEED);
+            SIM_CHECK(measuredSpeed > m.busSpeed * 8 / 10);
+            SIM_CHECK(m.ticks == TICK_TEST_MS);
+            SIM_CHECK(m.tickUnits >= (TICK_TEST_MS - 1) * sim::UNITS_PER_MS);
+            SIM_CHECK(m.tickUnits <= (TICK_TEST_MS + 1) * sim::UNITS_PER_MS);
+        }
+        SIM_CHECK(switchTicks == 350);
+        SIM_CHECK(switchUnits >= 349 * sim::UNITS_PER_MS && switchUnits <= 351 * sim::UNITS_PER_MS);
+        SIM_CHECK(Clocks::getSwitches() >= 100);
+
+        std::printf("%u profiles, slowest read at %u Hz, 100 switches: %u ticks in %u us\n", Clocks::COUNT, slowest,
+                    switchTicks, static_cast<uint32_t>(switchUnits * 1000 / sim::UNITS_PER_MS));
+        if(verbose()) {
+            for(uint8_t profile = 0; profile < Clocks::COUNT; profile++) {
+                const Measured& m = measured[profile];
+                std::printf("profile %u: %u MHz, SCL %u Hz, read at %u Hz, %u ticks in %u us\n", profile,
+                            m.ahbClock / 1000000, m.busSpeed,
+                            static_cast<uint32_t>(READ_BITS * sim::UNITS_PER_SECOND / m.readUnits), m.ticks,
+                            static_cast<uint32_t>(m.tickUnits * 1000 / sim::UNITS_PER_MS));
+            }
+        }
+    }, firmware);
+}
@@ -0,0 +1,106 @@
+// The span based rectangles change the same pixels as drawPixel/invertPixel loops over the area: fill,
+// clear and invert, page aligned or not, clipped at the right and the bottom edge, over a random
+// background. The page kernel of the streaming renderer is checked against the same reference.
+
+#include <cstring>
+
+#include "main.hpp"
+#include "sim_test.hpp"
+
+using namespace sim_test;
+
+namespace {
+
+using Display = SSD1306<I2c1>;
+constexpr uint32_t FRAME_SIZE = Display::WIDTH * Display::PAGES;
+
+struct Screen {
+    uint8_t buffer[Display::BUFFER_SIZE] = {};
+    Display display{0x3C << 1, buffer};
+
+    explicit Screen(uint32_t seed) {
+        for(uint32_t i = 0; i < FRAME_SIZE; i++) {
+            seed = seed * 1103515245 + 12345;
+            buffer[i] = static_cast<uint8_t>(seed >> 16);
+        }
+    }
+};
+
+struct Rect {
+    uint8_t x;
+    uint8_t y;
+    uint8_t width;
+    uint8_t height;
+};
+// the setup cursors, single rows and columns, whole pages and the edges
+constexpr Rect RECTS[] = {
+    {10, 39, 31, 17}, {14, 9, 16, 9}, {54, 9, 32, 9},
+    {0, 0, 1, 1}, {5, 3, 1, 60}, {0, 17, 128, 1},
+    {0, 8, 128, 8}, {20, 16, 40, 24}, {0, 0, 128, 64},
+    {100, 50, 40, 20}, {127, 63, 5, 5}, {60, 5, 10, 0}
+};
+constexpr SSD1306RectMode MODES[] = {SSD1306RectMode::fill, SSD1306RectMode::clear, SSD1306RectMode::invert};
+
+void drawPixels(Display& display, const Rect& rect, SSD1306RectMode mode) {
+    for(uint16_t x = rect.x; x < rect.x + rect.width; x++) {
+        for(uint16_t y = rect.y; y < rect.y + rect.height; y++) {
+            if(x >= Display::WIDTH || y >= Display::HEIGHT) {
+                continue;
+            }
+            if(mode == SSD1306RectMode::invert) {
+                display.invertPixel(x, y);
+            } else {
+                display.drawPixel(x, y, mode == SSD1306RectMode::fill);
+            }
+        }
+    }
+}
+
+// the rect over the background through ssd1306RenderPage, page by page
+void renderPages(uint8_t* frame, const Rect& rect, SSD1306RectMode mode) {
+    SSD1306DrawOp op = {};
+    op.type = SSD1306DrawOp::Type::rect;
+    op.x = rect.x;
+    op.y = rect.y;
+    op.rect = {rect.width, rect.height, mode};
+    for(uint8_t page = 0; page < Display::PAGES; page++) {
+        uint8_t* row = &frame[page * Display::WIDTH];
+        uint8_t background[Display::WIDTH];
+        std::memcpy(background, row, Display::WIDTH);
+        // the kernel starts every page from one background value, it is applied to 0x00 and 0xFF
+        // and the result is put together per bit
+        uint8_t onBlack[Display::WIDTH];
+        uint8_t onWhite[Display::WIDTH];
+        ssd1306RenderPage(onBlack, page, 0x00, &op, 1);
+        ssd1306RenderPage(onWhite, page, 0xFF, &op, 1);
+        for(uint8_t x = 0; x < Display::WIDTH; x++) {
+            row[x] = (background[x] & onWhite[x]) | (~background[x] & onBlack[x]);
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    uint32_t seed = 1;
+    for(const Rect& rect : RECTS) {
+        for(SSD1306RectMode mode : MODES) {
+            Screen reference(seed);
+            Screen tested(seed);
+            Screen streamed(seed);
+            seed++;
+            drawPixels(reference.display, rect, mode);
+            tested.display.drawRect(rect.x, rect.y, rect.width, rect.height, mode);
+            renderPages(streamed.buffer, rect, mode);
+            bool same = std::memcmp(reference.buffer, tested.buffer, FRAME_SIZE) == 0;
+            bool sameStreamed = std::memcmp(reference.buffer, streamed.buffer, FRAME_SIZE) == 0;
+            if(!same || !sameStreamed) {
+                std::fprintf(stderr, "rect %u,%u %ux%u mode %u\n", rect.x, rect.y, rect.width, rect.height,
+                             static_cast<unsigned>(mode));
+            }
+            SIM_CHECK(same);
+            SIM_CHECK(sameStreamed);
+        }
+    }
+    return report();
+}
@@ -0,0 +1,58 @@
+// Built for the page streaming and the frame buffer renderer, the same scenario writes every frame
+// as a PBM image to the file given on the command line. render_compare expects identical files.
+// The scenario covers the normal screen over an hour, the setup screen with the blinking cursor on
+// every field and the return to the normal screen.
+
+#include <fstream>
+
+#include "sim_test.hpp"
+
+using namespace sim_test;
+
+namespace {
+
+std::ofstream out;
+uint32_t frames = 0;
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if(argc != 2) {
+        std::fprintf(stderr, "usage: %s FRAMES.pbm\n", argv[0]);
+        return 2;
+    }
+    out.open(argv[1]);
+    static Ds3231Model rtc(sim::Port::C, 7);
+    static Ssd1306Model display;
+    rtc.setDateTime({25, 12, 31, 23, 59, 57});
+    rtc.setTemperature(-5);
+    display.setFrameCallback([](const Ssd1306Model::Frame& frame) {
+        frames++;
+        out << "P1\n" << int(Ssd1306Model::WIDTH) << ' ' << int(Ssd1306Model::HEIGHT) << '\n';
+        for(uint8_t y = 0; y < Ssd1306Model::HEIGHT; y++) {
+            for(uint8_t x = 0; x < Ssd1306Model::WIDTH; x++) {
+                out << (isLit(frame.image, x, y) ? '1' : '0');
+            }
+            out << '\n';
+        }
+    });
+
+    // The presses come between the new seconds and the blinks of the cursor every 200 ms. Changes
+    // closer than a transfer merge into one panel frame, and the renderers transfer at different speeds.
+    static sim::PinScript input;
+    press(input, MODE_PIN, 4100);
+    press(input, PLUS_PIN, 4700);
+    press(input, MINUS_PIN, 5300);
+    for(uint32_t i = 0; i < 6; i++) {
+        press(input, MODE_PIN, 5900 + i * 400);
+        if(i < 5) {
+            press(input, PLUS_PIN, 6100 + i * 400);
+        }
+    }
+
+    run(10000, []() {
+        out.close();
+        // new seconds, the blinking cursor and the edits
+        SIM_CHECK(frames > 20);
+    });
+}
@@ -0,0 +1,95 @@
+// The normal screen keeps the time in RAM: over 11 minutes the chip is read for the 10 minute resync
+// and the temperature every 64 s, its own conversion period. The old 50 ms loop read all 19 registers
+// every time, 22800 bytes a minute. The counter of the driver agrees with the bus model.
+
+#include <algorithm>
+#include <vector>
+
+#include "main.hpp"
+#include "sim_test.hpp"
+
+extern Rtc* pExtClock;
+
+using namespace sim_test;
+
+namespace {
+
+struct Shown {
+    uint64_t time;
+    std::string temperature;
+    uint32_t bytesRead;
+    uint32_t driverBytesRead;
+};
+std::vector<Shown> shown;
+
+constexpr uint32_t MINUTES = 11;
+constexpr uint32_t CHANGE_MS = 100000;
+constexpr uint32_t TEMPERATURE_PERIOD_MS = 64000;
+
+// the two digits in front of the degree sign
+std::string readTemperature(const Ssd1306Model::Image& image) {
+    return {readDigit(image, 97, 10, 1), readDigit(image, 105, 10, 1)};
+}
+
+// bytes read from the chip until the last frame before time
+uint32_t bytesReadBefore(uint64_t time) {
+    uint32_t bytes = 0;
+    for(const Shown& frame : shown) {
+        if(frame.time >= time) {
+            break;
+        }
+        bytes = frame.bytesRead;
+    }
+    return bytes;
+}
+
+} // namespace
+
+int main() {
+    static Ds3231Model rtc(sim::Port::C, 7);
+    static Ssd1306Model display;
+    rtc.setDateTime({25, 3, 14, 12, 0, 0});
+    rtc.setTemperature(21);
+    display.setFrameCallback([](const Ssd1306Model::Frame& frame) {
+        shown.push_back({frame.time, readTemperature(frame.image), sim::getI2cStats(Ds3231Model::ADDRESS).bytesRead,
+                         pExtClock->getBytesRead()});
+        if(frame.time >= CHANGE_MS * sim::UNITS_PER_MS) {
+            rtc.setTemperature(25);
+        }
+    });
+
+    run(MINUTES * 60000 + 500, []() {
+        SIM_CHECK(!shown.empty() && shown.front().temperature == "21");
+        bool counted = true;
+        for(const Shown& frame : shown) {
+            counted &= frame.driverBytesRead == frame.bytesRead;
+        }
+        SIM_CHECK(counted);
+        uint32_t worst = 0;
+        for(uint32_t minute = 1; minute < MINUTES; minute++) {
+            uint32_t bytes = bytesReadBefore((minute + 1) * 60000 * sim::UNITS_PER_MS)
+                - bytesReadBefore(minute * 60000 * sim::UNITS_PER_MS);
+            worst = std::max(worst, bytes);
+        }
+        // the resync and a temperature read fall into the same minute at most
+        SIM_CHECK(worst <= 32);
+        // the new temperature is read within one conversion period
+        bool updated = false;
+        for(const Shown& frame : shown) {
+            if(frame.time < (CHANGE_MS + TEMPERATURE_PERIOD_MS + 1000) * sim::UNITS_PER_MS && frame.temperature == "25") {
+                updated = true;
+            }
+        }
+        SIM_CHECK(updated);
+
+        std::printf("%u bytes read in %u minutes, %u in the worst minute\n",
+                    static_cast<uint32_t>(bytesReadBefore(MINUTES * 60000 * sim::UNITS_PER_MS)), MINUTES, worst);
+        if(verbose()) {
+            for(uint32_t minute = 1; minute < MINUTES; minute++) {
+                uint32_t bytes = bytesReadBefore((minute + 1) * 60000 * sim::UNITS_PER_MS)
+                    - bytesReadBefore(minute * 60000 * sim::UNITS_PER_MS);
+                std::printf("minute %u: %u bytes read\n", minute, bytes);
+            }
+        }
+    });
+}
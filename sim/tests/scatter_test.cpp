@@ -0,0 +1,78 @@
+// A full frame goes out in one transaction: the window commands and the 8 pages are segments of a
+// single START/STOP. Measured on the bus model against the former page loop, which sent a command
+// and a data transaction per page.
+
+#include "interrupts.hpp"
+#include "sim_test.hpp"
+
+using namespace sim_test;
+
+namespace {
+
+using Display = SSD1306<I2c1>;
+constexpr uint8_t ADDRESS = Ssd1306Model::ADDRESS << 1;
+uint8_t buffer[Display::BUFFER_SIZE];
+
+struct Cost {
+    uint32_t transactions;
+    uint32_t bytes;
+    uint64_t units;
+};
+Cost pageLoop;
+Cost segments;
+
+const sim::I2cStats& stats() {
+    return sim::getI2cStats(Ssd1306Model::ADDRESS);
+}
+
+template<typename Send>
+Cost measure(Send send) {
+    uint32_t transactions = stats().transactions;
+    uint32_t bytes = stats().bytesWritten;
+    uint64_t start = sim::now();
+    send();
+    return {stats().transactions - transactions, stats().bytesWritten - bytes, sim::now() - start};
+}
+
+void firmware() {
+    Clocks::init();
+    SysTickMsTimer::init();
+    I2c1SDA::init();
+    I2c1SCL::init();
+    I2c1::init();
+    static Display display(ADDRESS, buffer);
+    display.init();
+
+    pageLoop = measure([]() {
+        uint8_t commands[] = {0xB0, 0x00, 0x10};
+        for(uint8_t page = 0; page < Display::PAGES; page++) {
+            commands[0] = 0xB0 + page;
+            I2c1::memoryWrite(ADDRESS, 0x00, I2cMemAddrSize::oneByte, commands, sizeof(commands), 10);
+            I2c1::memoryWrite(ADDRESS, 0x40, I2cMemAddrSize::oneByte, &buffer[Display::WIDTH * page], Display::WIDTH, 10);
+        }
+    });
+    segments = measure([]() {
+        display.invalidate();
+        display.updateScreen();
+        display.waitForUpdate();
+    });
+}
+
+} // namespace
+
+int main() {
+    static Ssd1306Model display;
+    run(1000, []() {
+        SIM_CHECK(pageLoop.transactions == 2 * Display::PAGES);
+        SIM_CHECK(segments.transactions == 1);
+        // the frame plus 13 bytes of window commands and data control byte
+        SIM_CHECK(segments.bytes == Display::WIDTH * Display::PAGES + 13);
+        SIM_CHECK(segments.bytes < pageLoop.bytes);
+        SIM_CHECK(segments.units < pageLoop.units);
+
+        std::printf("page loop: %u transactions, %u bytes, %u us; segments: %u transactions, %u bytes, %u us\n",
+                    pageLoop.transactions, pageLoop.bytes,
+                    static_cast<uint32_t>(pageLoop.units * 1000000 / sim::UNITS_PER_SECOND), segments.transactions,
+                    segments.bytes, static_cast<uint32_t>(segments.units * 1000000 / sim::UNITS_PER_SECOND));
+    }, firmware);
+}
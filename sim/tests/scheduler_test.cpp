@@ -0,0 +1,136 @@
+// Scheduler on SysTickMsTimer: a periodic task starts every 10 ms and the scheduler sleeps in between,
+// a triggered task runs on the next pass, a task released with triggerAfter() runs at its time. The
+// slow task released together with the periodic one delays it past its deadline: one miss, the next
+// release stays on the period. The worst case times come from getMicros() around the runs.
+
+#include "interrupts.hpp"
+#include "sim_test.hpp"
+
+using namespace sim_test;
+
+namespace {
+
+enum TaskId : uint8_t {
+    SLOW_TASK,
+    PERIODIC_TASK,
+    TRIGGERED_TASK,
+    TASK_COUNT
+};
+void slowTask();
+void periodicTask();
+void triggeredTask();
+// the slow task comes first in the table, the periodic one waits for it
+constexpr SchedulerTask tasks[TASK_COUNT] = {
+    {slowTask, 0, 1},
+    {periodicTask, 10, 2},
+    {triggeredTask, 0, 1}
+};
+Scheduler<SysTickMsTimer, TASK_COUNT> scheduler(tasks);
+
+constexpr uint32_t PERIOD_MS = 10;
+constexpr uint32_t RUNS = 10;
+constexpr uint32_t SLOW_US = 5000;
+constexpr uint32_t TRIGGERED_US = 1000;
+// the periodic run that triggers the other tasks
+constexpr uint32_t TRIGGER_RUN = 3;
+constexpr uint32_t DELAY_RUN = 5;
+
+uint32_t startTicks = 0;
+uint32_t periodicStarts[RUNS + 1];
+uint32_t periodicRuns = 0;
+uint32_t slowStart = 0;
+uint32_t triggeredStart = 0;
+uint32_t idleMs = 0;
+SchedulerTaskStats stats[TASK_COUNT];
+uint32_t worstUs[TASK_COUNT];
+
+void spin(uint32_t us) {
+    uint32_t start = SysTickMsTimer::getMicros();
+    while(SysTickMsTimer::getMicros() - start < us) {}
+}
+
+void slowTask() {
+    slowStart = SysTickMsTimer::getTicks() - startTicks;
+    spin(SLOW_US);
+}
+
+void periodicTask() {
+    if(periodicRuns <= RUNS) {
+        periodicStarts[periodicRuns] = SysTickMsTimer::getTicks() - startTicks;
+    }
+    if(periodicRuns == TRIGGER_RUN) {
+        scheduler.trigger(TRIGGERED_TASK);
+    }
+    if(periodicRuns == DELAY_RUN) {
+        scheduler.triggerAfter(SLOW_TASK, PERIOD_MS);
+    }
+    periodicRuns++;
+}
+
+void triggeredTask() {
+    triggeredStart = SysTickMsTimer::getTicks() - startTicks;
+    spin(TRIGGERED_US);
+}
+
+void firmware() {
+    Clocks::init();
+    SysTickMsTimer::init();
+    SysTickMsTimer::delayMs(1);
+
+    uint32_t idle = SysTickMsTimer::getIdleMs();
+    startTicks = SysTickMsTimer::getTicks();
+    scheduler.restart();
+    while(SysTickMsTimer::getTicks() - startTicks < RUNS * PERIOD_MS) {
+        scheduler.runOnce();
+    }
+    idleMs = SysTickMsTimer::getIdleMs() - idle;
+    for(uint8_t i = 0; i < TASK_COUNT; i++) {
+        stats[i] = scheduler.getStats(i);
+        worstUs[i] = scheduler.getWorstCaseUs(i);
+    }
+}
+
+bool within(uint32_t value, uint32_t low, uint32_t high) {
+    return value >= low && value <= high;
+}
+
+} // namespace
+
+int main() {
+    run(1000, []() {
+        SIM_CHECK(periodicRuns == RUNS);
+        for(uint32_t i = 0; i < RUNS; i++) {
+            // the run after the slow task is late, the following ones are back on the period
+            uint32_t release = i * PERIOD_MS;
+            SIM_CHECK(i == DELAY_RUN + 1 ? within(periodicStarts[i], release + 5, release + 6)
+                                         : periodicStarts[i] == release);
+        }
+        const SchedulerTaskStats& periodic = stats[PERIODIC_TASK];
+        SIM_CHECK(periodic.runs == RUNS && periodic.misses == 1);
+        SIM_CHECK(within(periodic.worstLatencyMs, 5, 6));
+
+        // released by triggerAfter() one period after run 5, before the periodic task in the table
+        const SchedulerTaskStats& slow = stats[SLOW_TASK];
+        SIM_CHECK(slow.runs == 1 && slow.misses == 0 && slow.worstLatencyMs == 0);
+        SIM_CHECK(slowStart == (DELAY_RUN + 1) * PERIOD_MS);
+        SIM_CHECK(within(worstUs[SLOW_TASK], SLOW_US, SLOW_US + 50) && slow.worstUs == worstUs[SLOW_TASK]);
+
+        // triggered by run 3, runs on the pass after it
+        const SchedulerTaskStats& triggered = stats[TRIGGERED_TASK];
+        SIM_CHECK(triggered.runs == 1 && triggered.misses == 0 && triggered.worstLatencyMs == 0);
+        SIM_CHECK(triggeredStart == TRIGGER_RUN * PERIOD_MS);
+        SIM_CHECK(within(worstUs[TRIGGERED_TASK], TRIGGERED_US, TRIGGERED_US + 50));
+        SIM_CHECK(worstUs[PERIODIC_TASK] < 50);
+
+        // sleeping between the releases, the busy waits are the active time
+        uint32_t active = (SLOW_US + TRIGGERED_US) / 1000;
+        SIM_CHECK(within(idleMs, RUNS * PERIOD_MS - active - 3, RUNS * PERIOD_MS - active));
+        if(failures != 0) {
+            for(uint32_t i = 0; i < RUNS; i++) {
+                std::fprintf(stderr, "periodic run %u at %u ms\n", i, periodicStarts[i]);
+            }
+            std::fprintf(stderr, "slow at %u ms, %u us; triggered at %u ms, %u us; idle %u ms\n", slowStart,
+                         worstUs[SLOW_TASK], triggeredStart, worstUs[TRIGGERED_TASK], idleMs);
+        }
+    }, firmware);
+}
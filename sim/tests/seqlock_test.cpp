@@ -0,0 +1,118 @@
+// getSnapshot() never returns a time mixing two reads. The read is single stepped with the x86 trap
+// flag and a background read completes at each of its instructions in turn, as the I2C interrupt
+// would: every snapshot must still have all fields from one register image. A timer is too coarse
+// here, the copy is two loads and an interrupt between them is rare.
+
+#include <csignal>
+#include <ucontext.h>
+
+#include "sim_test.hpp"
+
+#include "ds3231.hpp"
+
+using namespace sim_test;
+
+namespace {
+
+// keeps the transaction the driver queued, the interrupt completes it
+struct FakeBus {
+    static inline I2cTransaction pending = {};
+
+    static bool submit(const I2cTransaction& transaction) {
+        pending = transaction;
+        return true;
+    }
+};
+
+DS3231<FakeBus> rtc(0x68 << 1);
+
+uint8_t image = 0;
+
+uint8_t bcd(uint8_t value) {
+    return static_cast<uint8_t>((value / 10) << 4 | value % 10);
+}
+
+// the next register image, all fields are derived from one value from 0 to 59
+void completeRead() {
+    image = (image + 1) % 60;
+    uint8_t* registers = FakeBus::pending.data;
+    registers[0x00] = bcd(image);
+    registers[0x01] = bcd(image);
+    registers[0x02] = bcd(image % 24);
+    registers[0x04] = bcd(image % 28 + 1);
+    registers[0x05] = bcd(image % 12 + 1);
+    registers[0x06] = bcd(image);
+    registers[0x11] = image;
+    FakeBus::pending.callback(FakeBus::pending.context, 0);
+}
+
+bool isConsistent(const DS3231Snapshot& snapshot) {
+    uint8_t k = snapshot.time.seconds;
+    return snapshot.time.minutes == k && snapshot.time.hours == k % 24 && snapshot.date.date == k % 28 + 1
+        && snapshot.date.month == k % 12 + 1 && snapshot.date.year == k && snapshot.temperature == k;
+}
+
+#if defined(__x86_64__) && defined(__linux__)
+
+constexpr uint64_t TRAP_FLAG = 0x100;
+
+volatile uint32_t steps = 0;
+volatile uint32_t interruptAt = 0;
+
+// runs after every instruction while the trap flag is set
+void onStep(int, siginfo_t*, void*) {
+    steps = steps + 1;
+    if(steps == interruptAt) {
+        completeRead();
+    }
+}
+
+void setTrapFlag() {
+    asm volatile("pushfq\n orq %0, (%%rsp)\n popfq" : : "i"(TRAP_FLAG) : "memory", "cc");
+}
+
+void clearTrapFlag() {
+    asm volatile("pushfq\n andq %0, (%%rsp)\n popfq" : : "i"(~TRAP_FLAG) : "memory", "cc");
+}
+
+#endif
+
+} // namespace
+
+int main() {
+    rtc.readDataAsync();
+    SIM_CHECK(FakeBus::pending.size == DS3231<FakeBus>::DATA_SIZE);
+    completeRead();
+    SIM_CHECK(isConsistent(rtc.getSnapshot()));
+
+#if defined(__x86_64__) && defined(__linux__)
+    struct sigaction action = {};
+    action.sa_sigaction = onStep;
+    action.sa_flags = SA_SIGINFO;
+    sigaction(SIGTRAP, &action, nullptr);
+
+    // one read per instruction position, until the read ends before the interrupt comes
+    uint32_t positions = 0;
+    for(uint32_t at = 1;; at++) {
+        uint8_t before = image;
+        steps = 0;
+        interruptAt = at;
+        setTrapFlag();
+        DS3231Snapshot snapshot = rtc.getSnapshot();
+        clearTrapFlag();
+        if(image == before) {
+            break;
+        }
+        positions++;
+        if(!isConsistent(snapshot)) {
+            std::fprintf(stderr, "torn snapshot with the interrupt at instruction %u\n", at);
+        }
+        SIM_CHECK(isConsistent(snapshot));
+    }
+    std::printf("interrupted the read at %u instructions\n", positions);
+    SIM_CHECK(positions > 8);
+#else
+    std::printf("single stepping needs x86-64 Linux, only the plain read was checked\n");
+#endif
+    return report();
+}
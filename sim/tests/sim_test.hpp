@@ -0,0 +1,158 @@
+#pragma once
+
+// Helpers of the firmware tests. A test sets the models up, scripts the input, runs the firmware
+// with run() and checks what the display and the chips saw from the end callback. Every test is
+// its own program: the firmware keeps its state in globals and the run ends the process.
+// Driver tests include interrupts.hpp for the handlers and run their own entry instead of runClock().
+
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+
+#include "mcu.hpp"
+#include "harness.hpp"
+#include "ds3231_model.hpp"
+#include "ssd1306_model.hpp"
+
+// src/clock.cpp
+void runClock();
+
+namespace sim_test {
+
+inline uint32_t failures = 0;
+
+inline void check(bool ok, const char* condition, const char* file, int line) {
+    if(!ok) {
+        failures++;
+        std::fprintf(stderr, "%s:%d: at %u ms: check failed: %s\n", file, line, sim::nowMs(), condition);
+    }
+}
+#define SIM_CHECK(condition) sim_test::check((condition), #condition, __FILE__, __LINE__)
+
+// A test prints one summary line of its measured figures. The single measurements follow after a
+// failed check or with SIM_VERBOSE set in the environment.
+inline bool verbose() {
+    static const bool set = std::getenv("SIM_VERBOSE") != nullptr;
+    return set || failures != 0;
+}
+
+// the exit code of a test, for tests that only call driver code and do not run the firmware
+inline int report() {
+    std::fflush(stdout);
+    std::fprintf(stderr, failures == 0 ? "passed\n" : "%u checks failed\n", failures);
+    return failures == 0 ? 0 : 1;
+}
+
+// Runs the firmware until endMs, then calls checks and ends the process with the result.
+// A driver test passes its own entry, the run also ends when it returns.
+[[noreturn]] inline void run(uint32_t endMs, std::function<void()> checks, void (*entry)() = runClock) {
+    sim::setEnd(endMs, [checks]() {
+        checks();
+        std::exit(report());
+    });
+    std::exit(sim::runFirmwareThread(entry));
+}
+
+// Buttons on port C, pressed pins are pulled low
+constexpr uint8_t MODE_PIN = 0;
+constexpr uint8_t PLUS_PIN = 3;
+constexpr uint8_t MINUS_PIN = 4;
+
+inline void press(sim::PinScript& input, uint8_t pin, uint32_t atMs, uint32_t holdMs = 100) {
+    input.add(atMs * sim::UNITS_PER_MS, sim::Port::C, pin, true);
+    input.add((atMs + holdMs) * sim::UNITS_PER_MS, sim::Port::C, pin, false);
+}
+
+// The digits of the firmware 8x8 font, the large digits are the same scaled by 2
+constexpr uint8_t DIGITS[10][8] = {
+    {0x3C, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x3C},
+    {0x08, 0x18, 0x08, 0x08, 0x08, 0x08, 0x08, 0x1C},
+    {0x3C, 0x42, 0x02, 0x1C, 0x20, 0x40, 0x42, 0x7E},
+    {0x3C, 0x42, 0x02, 0x1C, 0x02, 0x02, 0x42, 0x3C},
+    {0x04, 0x0C, 0x14, 0x24, 0x44, 0x7E, 0x04, 0x04},
+    {0x7E, 0x40, 0x40, 0x7C, 0x02, 0x02, 0x42, 0x3C},
+    {0x3C, 0x42, 0x40, 0x7C, 0x42, 0x42, 0x42, 0x3C},
+    {0x7E, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x40},
+    {0x3C, 0x42, 0x42, 0x3C, 0x42, 0x42, 0x42, 0x3C},
+    {0x3C, 0x42, 0x42, 0x42, 0x3E, 0x02, 0x42, 0x3C}
+};
+
+inline bool isLit(const Ssd1306Model::Image& image, uint8_t x, uint8_t y) {
+    return image[y * Ssd1306Model::WIDTH + x] != 0;
+}
+
+// The digit with its top left corner at x, y, '?' for anything else. An inverted cell under the
+// setup cursor reads the same.
+inline char readDigit(const Ssd1306Model::Image& image, uint8_t x, uint8_t y, uint8_t scale) {
+    uint8_t rows[8] = {};
+    for(uint8_t row = 0; row < 8; row++) {
+        for(uint8_t column = 0; column < 8; column++) {
+            if(isLit(image, x + column * scale, y + row * scale)) {
+                rows[row] |= static_cast<uint8_t>(0x80 >> column);
+            }
+        }
+    }
+    for(uint8_t digit = 0; digit < 10; digit++) {
+        bool same = true;
+        bool inverted = true;
+        for(uint8_t row = 0; row < 8; row++) {
+            same &= rows[row] == DIGITS[digit][row];
+            inverted &= rows[row] == static_cast<uint8_t>(~DIGITS[digit][row]);
+        }
+        if(same || inverted) {
+            return static_cast<char>('0' + digit);
+        }
+    }
+    return '?';
+}
+
+// "hh:mm:ss" of the large time row, the normal and the setup screen put it at the same place
+inline std::string readTime(const Ssd1306Model::Image& image) {
+    std::string text;
+    for(uint8_t x : {10, 26, 0, 50, 66, 0, 90, 106}) {
+        text += x == 0 ? ':' : readDigit(image, x, 40, 2);
+    }
+    return text;
+}
+
+// "dd.mm" of the date row
+inline std::string readDate(const Ssd1306Model::Image& image) {
+    std::string text;
+    for(uint8_t x : {14, 22, 0, 34, 42}) {
+        text += x == 0 ? '.' : readDigit(image, x, 10, 1);
+    }
+    return text;
+}
+
+// "20yy" of the setup screen
+inline std::string readYear(const Ssd1306Model::Image& image) {
+    std::string text;
+    for(uint8_t x : {54, 62, 70, 78}) {
+        text += readDigit(image, x, 10, 1);
+    }
+    return text;
+}
+
+// The setup cursor inverts the field frame, its top left corner is blank otherwise
+enum struct Field : uint8_t {none, hours, minutes, seconds, date, month, year};
+
+inline Field readCursor(const Ssd1306Model::Image& image) {
+    struct Corner {
+        Field field;
+        uint8_t x;
+        uint8_t y;
+    };
+    static constexpr Corner CORNERS[] = {
+        {Field::hours, 10, 39}, {Field::minutes, 50, 39}, {Field::seconds, 90, 39},
+        {Field::date, 14, 9}, {Field::month, 34, 9}, {Field::year, 54, 9}
+    };
+    for(const Corner& corner : CORNERS) {
+        if(isLit(image, corner.x, corner.y)) {
+            return corner.field;
+        }
+    }
+    return Field::none;
+}
+
+} // namespace sim_test
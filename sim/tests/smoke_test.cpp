@@ -0,0 +1,87 @@
+// The clock runs over the full hour from 12:59:58, then the time is set one hour ahead with the
+// buttons: Mode enters setup on the hours, Plus steps them, Mode walks through the fields and
+// writes the chip after the year.
+
+#include <vector>
+
+#include "sim_test.hpp"
+
+using namespace sim_test;
+
+namespace {
+
+struct Shown {
+    uint64_t time;
+    std::string clock;
+    std::string date;
+    std::string year;
+    Field cursor;
+};
+std::vector<Shown> shown;
+
+// first frame at or after fromMs that shows text as the time, nullptr if none came
+const Shown* findTime(const std::string& text, uint32_t fromMs = 0) {
+    for(const Shown& frame : shown) {
+        if(frame.time >= fromMs * sim::UNITS_PER_MS && frame.clock == text) {
+            return &frame;
+        }
+    }
+    return nullptr;
+}
+
+bool anyFrame(uint32_t fromMs, uint32_t toMs, bool (*match)(const Shown&)) {
+    for(const Shown& frame : shown) {
+        if(frame.time >= fromMs * sim::UNITS_PER_MS && frame.time < toMs * sim::UNITS_PER_MS && match(frame)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+int main() {
+    static Ds3231Model rtc(sim::Port::C, 7);
+    static Ssd1306Model display;
+    rtc.setDateTime({25, 3, 14, 12, 59, 58});
+    display.setFrameCallback([](const Ssd1306Model::Frame& frame) {
+        shown.push_back({frame.time, readTime(frame.image), readDate(frame.image), readYear(frame.image),
+                         readCursor(frame.image)});
+    });
+
+    static sim::PinScript input;
+    press(input, MODE_PIN, 3000);
+    press(input, PLUS_PIN, 3600);
+    // minutes, seconds, date, month, year, back to the time
+    for(uint32_t i = 0; i < 6; i++) {
+        press(input, MODE_PIN, 4200 + i * 300);
+    }
+
+    run(7000, []() {
+        // the chip turns to 13:00:00 at 2000 ms, the new second is shown within a few ms
+        const Shown* before = findTime("12:59:59");
+        const Shown* after = findTime("13:00:00");
+        SIM_CHECK(before != nullptr);
+        SIM_CHECK(after != nullptr);
+        if(before != nullptr && after != nullptr) {
+            SIM_CHECK(before->time < after->time);
+            SIM_CHECK(after->time >= 2000 * sim::UNITS_PER_MS);
+            SIM_CHECK(after->time < 2050 * sim::UNITS_PER_MS);
+            SIM_CHECK(after->date == "14.03");
+        }
+        // setup shows the year and blinks the cursor on the hours, Plus makes them 14
+        SIM_CHECK(anyFrame(3000, 3600, [](const Shown& frame) {
+            return frame.cursor == Field::hours && frame.year == "2025";
+        }));
+        SIM_CHECK(anyFrame(3600, 4200, [](const Shown& frame) { return frame.clock.substr(0, 2) == "14"; }));
+        SIM_CHECK(anyFrame(4200, 4500, [](const Shown& frame) { return frame.cursor == Field::minutes; }));
+        SIM_CHECK(anyFrame(5400, 5700, [](const Shown& frame) { return frame.cursor == Field::year; }));
+        // leaving setup writes the chip and the normal screen runs on from the new time
+        Ds3231Model::DateTime time = rtc.getDateTime();
+        SIM_CHECK(time.hours == 14);
+        SIM_CHECK(time.minutes == 0);
+        SIM_CHECK(time.date == 14 && time.month == 3 && time.year == 25);
+        SIM_CHECK(!shown.empty() && shown.back().cursor == Field::none);
+        SIM_CHECK(findTime("14:00:0" + std::to_string(time.seconds), 6000) != nullptr);
+    });
+}
@@ -0,0 +1,46 @@
+// With RTC_SECOND_TICK the DS3231 square wave on PC7 marks the new second: the falling edge starts
+// the clock task, the new second is drawn once right after it and the chip is not polled.
+
+#include <vector>
+
+#include "sim_test.hpp"
+
+using namespace sim_test;
+
+namespace {
+
+struct Shown {
+    uint64_t time;
+    std::string clock;
+    uint32_t rtcTransactions;
+};
+std::vector<Shown> shown;
+
+// render and transfer of the changed digits at 48 MHz
+constexpr uint32_t EDGE_TO_FRAME_MS = 30;
+
+} // namespace
+
+int main() {
+    static Ds3231Model rtc(sim::Port::C, 7);
+    static Ssd1306Model display;
+    rtc.setDateTime({25, 3, 14, 12, 59, 55});
+    display.setFrameCallback([](const Ssd1306Model::Frame& frame) {
+        shown.push_back({frame.time, readTime(frame.image), sim::getI2cStats(Ds3231Model::ADDRESS).transactions});
+    });
+
+    run(5500, []() {
+        // INTCN off and RS at 1 Hz
+        SIM_CHECK((rtc.getRegister(0x0E) & 0x1C) == 0);
+        // the first frame after start up, then one per chip second, which starts every 1000 ms
+        static const char* const EXPECTED[] = {"12:59:55", "12:59:56", "12:59:57", "12:59:58", "12:59:59", "13:00:00"};
+        SIM_CHECK(shown.size() == 6);
+        for(size_t i = 1; i < shown.size() && i < 6; i++) {
+            SIM_CHECK(shown[i].clock == EXPECTED[i]);
+            SIM_CHECK(shown[i].time >= i * 1000 * sim::UNITS_PER_MS);
+            SIM_CHECK(shown[i].time < (i * 1000 + EDGE_TO_FRAME_MS) * sim::UNITS_PER_MS);
+        }
+        // the local time runs on, the chip is not read after start up
+        SIM_CHECK(!shown.empty() && sim::getI2cStats(Ds3231Model::ADDRESS).transactions == shown.front().rtcTransactions);
+    });
+}
@@ -0,0 +1,84 @@
+// SysTickMs on the register models: an idle() of 100 ms stretches the tick to one compare period and
+// counts the whole sleep as idle, idle plus active milliseconds stay equal to the ticks, getMicros()
+// follows the sleep. getMicros() and addTicks() leave the interrupts of the caller as they were, as
+// Pwr::standby() needs when it advances the ticks with interrupts disabled.
+
+#include "interrupts.hpp"
+#include "sim_test.hpp"
+
+using namespace sim_test;
+
+namespace {
+
+constexpr uint32_t SLEEP_MS = 100;
+constexpr uint32_t MIE = 0x08;
+
+struct Sleep {
+    uint32_t ticks;
+    uint32_t idleMs;
+    uint32_t activeMs;
+    uint32_t micros;
+    uint32_t interrupts;
+};
+Sleep sleep;
+bool accountedBefore = false;
+bool accountedAfter = false;
+bool microsKeptDisabled = false;
+bool addTicksKeptDisabled = false;
+bool microsKeptEnabled = false;
+bool addTicksKeptEnabled = false;
+uint32_t addedTicks = 0;
+
+bool isAccounted() {
+    return SysTickMsTimer::getIdleMs() + SysTickMsTimer::getActiveMs() == SysTickMsTimer::getTicks();
+}
+
+void firmware() {
+    Clocks::init();
+    SysTickMsTimer::init();
+    // from the start of a tick, the compare is stretched only with time left in the millisecond
+    SysTickMsTimer::delayMs(1);
+
+    accountedBefore = isAccounted();
+    uint32_t ticks = SysTickMsTimer::getTicks();
+    uint32_t idleMs = SysTickMsTimer::getIdleMs();
+    uint32_t activeMs = SysTickMsTimer::getActiveMs();
+    uint32_t micros = SysTickMsTimer::getMicros();
+    uint32_t interrupts = sim::getInterruptCount();
+    __disable_irq();
+    SysTickMsTimer::idle(SLEEP_MS);
+    sleep = {SysTickMsTimer::getTicks() - ticks, SysTickMsTimer::getIdleMs() - idleMs,
+             SysTickMsTimer::getActiveMs() - activeMs, SysTickMsTimer::getMicros() - micros,
+             sim::getInterruptCount() - interrupts};
+    accountedAfter = isAccounted();
+
+    __disable_irq();
+    SysTickMsTimer::getMicros();
+    microsKeptDisabled = (__get_MSTATUS() & MIE) == 0;
+    ticks = SysTickMsTimer::getTicks();
+    SysTickMsTimer::addTicks(5);
+    addTicksKeptDisabled = (__get_MSTATUS() & MIE) == 0;
+    addedTicks = SysTickMsTimer::getTicks() - ticks;
+    __enable_irq();
+    SysTickMsTimer::getMicros();
+    microsKeptEnabled = (__get_MSTATUS() & MIE) != 0;
+    SysTickMsTimer::addTicks(0);
+    addTicksKeptEnabled = (__get_MSTATUS() & MIE) != 0;
+}
+
+} // namespace
+
+int main() {
+    run(1000, []() {
+        SIM_CHECK(accountedBefore && accountedAfter);
+        SIM_CHECK(sleep.ticks == SLEEP_MS);
+        SIM_CHECK(sleep.idleMs + sleep.activeMs == sleep.ticks);
+        // the part of the millisecond before the sleep was running
+        SIM_CHECK(sleep.idleMs == SLEEP_MS - 1 || sleep.idleMs == SLEEP_MS);
+        SIM_CHECK(sleep.micros >= (SLEEP_MS - 1) * 1000 && sleep.micros <= (SLEEP_MS + 1) * 1000);
+        // one tick for the whole sleep
+        SIM_CHECK(sleep.interrupts == 1);
+        SIM_CHECK(microsKeptDisabled && addTicksKeptDisabled && addedTicks == 5);
+        SIM_CHECK(microsKeptEnabled && addTicksKeptEnabled);
+    }, firmware);
+}
@@ -0,0 +1,117 @@
+// Pwr::standby() on the register models: the AWU ends a standby after the programmed window,
+// rounded to 16 ms steps and limited to 1008 ms, a button EXTI line ends it early. Afterwards
+// SLEEPDEEP, PDDS and the AWU are off, the PLL runs again, the ticks are advanced and the
+// residency adds up. A button edge pending before the WFI returns at once instead of being lost.
+
+#include "interrupts.hpp"
+#include "sim_test.hpp"
+
+using namespace sim_test;
+
+namespace {
+
+constexpr uint32_t AWU_LINE = 1 << 9;
+constexpr uint32_t PRESS_MS = 2300;
+
+struct Wake {
+    WakeSource source;
+    uint64_t units;
+    uint32_t ticks;
+    bool restored;
+};
+Wake hundred;
+Wake shortest;
+Wake longest;
+Wake pressed;
+Wake pending;
+uint64_t pressedAt = 0;
+uint32_t standbyMs = 0;
+uint32_t awuWakeUps = 0;
+uint32_t extiWakeUps = 0;
+
+// the counter keeps the part of a millisecond it had before the standby
+bool advancedBy(const Wake& wake, uint32_t ms) {
+    return wake.ticks == ms || wake.ticks == ms + 1;
+}
+
+// standby() and the state it leaves behind
+Wake measure(uint32_t ms) {
+    uint64_t start = sim::now();
+    uint32_t ticks = SysTickMsTimer::getTicks();
+    WakeSource source = Power::standby(ms);
+    Wake wake = {source, sim::now() - start, SysTickMsTimer::getTicks() - ticks, true};
+    wake.restored = (NVIC->SCTLR & PFIC_SCTLR_SLEEPDEEP) == 0 && (PWR->CTLR & PWR_CTLR_PDDS) == 0
+        && (PWR->AWUCSR & PWR_AWUCSR_AWUEN) == 0 && (RCC->CFGR0 & RCC_SWS) == RCC_SWS_PLL
+        && (EXTI->INTFR & AWU_LINE) == 0;
+    return wake;
+}
+
+uint32_t toMs(uint64_t units) {
+    return static_cast<uint32_t>(units / sim::UNITS_PER_MS);
+}
+
+void firmware() {
+    Clocks::init();
+    SysTickMsTimer::init();
+    ButtonInput::init();
+    Power::init();
+
+    hundred = measure(100);
+    shortest = measure(1);
+    longest = measure(5000);
+    // the plus button is pressed in the middle of the standby
+    while(sim::nowMs() < PRESS_MS - 500) {
+        SysTickMsTimer::delayMs(1);
+    }
+    pressed = measure(1000);
+    pressedAt = sim::now();
+    SysTickMsTimer::delayMs(200);
+    // an edge between the decision to sleep and the WFI
+    __disable_irq();
+    sim::drivePin(sim::Port::C, MINUS_PIN, true);
+    pending = measure(500);
+    sim::drivePin(sim::Port::C, MINUS_PIN, false);
+
+    standbyMs = Power::getResidencyMs(PowerState::standby);
+    awuWakeUps = Power::getWakeUps(WakeSource::awu);
+    extiWakeUps = Power::getWakeUps(WakeSource::exti);
+}
+
+} // namespace
+
+int main() {
+    static sim::PinScript input;
+    press(input, PLUS_PIN, PRESS_MS);
+    run(5000, []() {
+        for(const Wake* wake : {&hundred, &shortest, &longest, &pressed, &pending}) {
+            SIM_CHECK(wake->restored);
+        }
+        // 7 AWU steps, the LSI runs at its nominal 128 kHz in the model
+        SIM_CHECK(hundred.source == WakeSource::awu);
+        SIM_CHECK(toMs(hundred.units) >= 112 && toMs(hundred.units) < 114);
+        SIM_CHECK(advancedBy(hundred, 112));
+        SIM_CHECK(shortest.source == WakeSource::awu && advancedBy(shortest, Power::AWU_STEP_MS));
+        SIM_CHECK(longest.source == WakeSource::awu && advancedBy(longest, Power::MAX_STANDBY_MS));
+        // the press ends the standby, half the window is counted
+        SIM_CHECK(pressed.source == WakeSource::exti);
+        SIM_CHECK(pressedAt >= PRESS_MS * sim::UNITS_PER_MS && pressedAt < (PRESS_MS + 1) * sim::UNITS_PER_MS);
+        SIM_CHECK(advancedBy(pressed, Power::MAX_STANDBY_MS / 2));
+        SIM_CHECK(pending.source == WakeSource::exti);
+        SIM_CHECK(pending.units < sim::UNITS_PER_MS);
+        SIM_CHECK(awuWakeUps == 3 && extiWakeUps == 2);
+        SIM_CHECK(standbyMs == 112 + 16 + 1008 + 504 + 256);
+        // the model counts the real standby time
+        sim::Residency residency = sim::getResidency();
+        SIM_CHECK(toMs(residency.standby) >= 112 + 16 + 1008 + 499);
+        SIM_CHECK(toMs(residency.standby) < 112 + 16 + 1008 + 499 + 5);
+
+        std::printf("%u AWU and %u EXTI wake-ups, %u ms in standby counted, %u ms in the model\n", awuWakeUps,
+                    extiWakeUps, standbyMs, toMs(residency.standby));
+        if(verbose()) {
+            for(const Wake* wake : {&hundred, &shortest, &longest, &pressed, &pending}) {
+                std::printf("wake-up %u after %u ms, ticks +%u\n", static_cast<unsigned>(wake->source),
+                            toMs(wake->units), wake->ticks);
+            }
+        }
+    }, firmware);
+}
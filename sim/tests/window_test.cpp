@@ -0,0 +1,115 @@
+// SSD1306::updateWindow() on the panel model: one transaction with the window commands and the
+// columns of each page, the panel shows the buffer afterwards and the next updateScreen() has nothing
+// left to send. The window is clipped to the panel, an empty one sends nothing. A window lost on the
+// bus is marked dirty again and goes out with the next update.
+
+#include "interrupts.hpp"
+#include "sim_test.hpp"
+
+using namespace sim_test;
+
+namespace {
+
+using Display = SSD1306<I2c1>;
+uint8_t buffer[Display::BUFFER_SIZE];
+
+// the column and page address commands with their control bytes, and the data control byte
+constexpr uint32_t HEADER = 13;
+
+struct Cost {
+    uint32_t transactions;
+    uint32_t bytes;
+    bool same;
+};
+Cost inside;
+Cost afterInside;
+Cost clipped;
+Cost empty;
+Cost lost;
+Cost resent;
+
+const sim::I2cStats& stats() {
+    return sim::getI2cStats(Ssd1306Model::ADDRESS);
+}
+
+Ssd1306Model* model = nullptr;
+
+bool panelShowsBuffer() {
+    const Ssd1306Model::Image& image = model->getImage();
+    for(uint8_t y = 0; y < Ssd1306Model::HEIGHT; y++) {
+        for(uint8_t x = 0; x < Ssd1306Model::WIDTH; x++) {
+            bool lit = (buffer[(y / 8) * Display::WIDTH + x] >> (y % 8)) & 1;
+            if(lit != isLit(image, x, y)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template<typename Update>
+Cost measure(Display& display, Update update) {
+    uint32_t transactions = stats().transactions;
+    uint32_t bytes = stats().bytesWritten;
+    update();
+    display.waitForUpdate();
+    // lets the panel model settle on the new picture
+    SysTickMsTimer::delayMs(5);
+    return {stats().transactions - transactions, stats().bytesWritten - bytes, panelShowsBuffer()};
+}
+
+void firmware() {
+    Clocks::init();
+    SysTickMsTimer::init();
+    I2c1SDA::init();
+    I2c1SCL::init();
+    I2c1::init();
+    static Display display(0x3C << 1, buffer);
+    display.init();
+    for(uint32_t i = 0; i < Display::WIDTH * Display::PAGES; i++) {
+        buffer[i] = static_cast<uint8_t>(i * 5 + i / Display::WIDTH);
+    }
+    display.invalidate();
+    measure(display, []() { display.updateScreen(); });
+
+    // pages 1 to 3, columns 20 to 49 change, the window is wider
+    inside = measure(display, []() {
+        display.invertRect(20, 12, 30, 20);
+        display.updateWindow(16, 63, 1, 3);
+    });
+    afterInside = measure(display, []() { display.updateScreen(); });
+    // clipped to columns 96 to 127 and pages 5 to 7
+    clipped = measure(display, []() {
+        display.invertRect(100, 40, 28, 24);
+        display.updateWindow(96, 200, 5, 12);
+    });
+    empty = measure(display, []() {
+        display.updateWindow(50, 40, 0, 0);
+        display.updateWindow(130, 140, 0, 0);
+        display.updateWindow(0, 10, 3, 2);
+    });
+
+    sim::stallI2c(true);
+    lost = measure(display, []() {
+        display.fillRect(0, 0, 10, 16);
+        display.updateWindow(0, 15, 0, 1);
+    });
+    sim::stallI2c(false);
+    // the whole window again, not only the changed columns
+    resent = measure(display, []() { display.updateScreen(); });
+}
+
+} // namespace
+
+int main() {
+    static Ssd1306Model display;
+    model = &display;
+    run(2000, []() {
+        SIM_CHECK(inside.transactions == 1 && inside.bytes == HEADER + 48 * 3 && inside.same);
+        SIM_CHECK(afterInside.transactions == 0);
+        SIM_CHECK(clipped.transactions == 1 && clipped.bytes == HEADER + 32 * 3 && clipped.same);
+        SIM_CHECK(empty.transactions == 0);
+        SIM_CHECK(lost.bytes == 0 && !lost.same);
+        SIM_CHECK(resent.transactions == 1 && resent.bytes == HEADER + 16 * 2 && resent.same);
+    }, firmware);
+}
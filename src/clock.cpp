@@ -0,0 +1,470 @@
+// Copyright (c) 2025 Perevozchikov Aleksei [ATwice291]
+// Licensed under the MIT License. See LICENSE file.
+
+#include "main.hpp"
+#include "interrupts.hpp"
+
+Rtc* pExtClock;
+RtcClock* pClock;
+Oled* pOledDisplay;
+
+uint8_t oledBuf[Oled::BUFFER_SIZE];
+
+static constexpr uint8_t FONT_SIZE = 13;
+static constexpr uint8_t font8x8[FONT_SIZE][8] = {
+    {0x3C, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x3C}, // 0
+    {0x08, 0x18, 0x08, 0x08, 0x08, 0x08, 0x08, 0x1C}, // 1
+    {0x3C, 0x42, 0x02, 0x1C, 0x20, 0x40, 0x42, 0x7E}, // 2
+    {0x3C, 0x42, 0x02, 0x1C, 0x02, 0x02, 0x42, 0x3C}, // 3
+    {0x04, 0x0C, 0x14, 0x24, 0x44, 0x7E, 0x04, 0x04}, // 4
+    {0x7E, 0x40, 0x40, 0x7C, 0x02, 0x02, 0x42, 0x3C}, // 5
+    {0x3C, 0x42, 0x40, 0x7C, 0x42, 0x42, 0x42, 0x3C}, // 6
+    {0x7E, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x40}, // 7
+    {0x3C, 0x42, 0x42, 0x3C, 0x42, 0x42, 0x42, 0x3C}, // 8
+    {0x3C, 0x42, 0x42, 0x42, 0x3E, 0x02, 0x42, 0x3C}, // 9
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x60, 0x60}, //.
+    {0x00, 0x00, 0x60, 0x60, 0x00, 0x60, 0x60, 0x00}, //:
+    {0x30, 0x48, 0x48, 0x30, 0x00, 0x00, 0x00, 0x00}  //D is DEGREES
+};
+// in display page layout, built by the compiler
+static constexpr auto fontColumns8x8 = transposeFont8x8(font8x8);
+static constexpr auto font16x16 = scaleFont16x16(font8x8);
+static constexpr uint8_t UNKNOWN_GLYPH = 10; // '.' for all unknown symbols
+static constexpr SSD1306CharMap charMap = makeCharMap("0123456789.:D", UNKNOWN_GLYPH);
+// the separators only use the left columns of their cell, full cells would cover the next digit
+// and resend it with every frame
+static constexpr auto colon16x16 = cropGlyph<8>(font16x16[charMap[':']]);
+static constexpr auto dot8x8 = cropGlyph<4>(fontColumns8x8[charMap['.']]);
+
+enum struct ClockState{
+    NORMAL,
+    SETUP
+} clockState; 
+enum struct SetupState {
+    HOURS,
+    MINUTES,
+    SECONDS,
+    DATE,
+    MONTH,
+    YEAR,
+    STATES_COUNT
+} setupState;
+
+// cursor frame of every setup field, its digits start one row below
+struct SetupField {
+  uint8_t x, y, width, height;
+};
+static constexpr SetupField setupFields[static_cast<uint8_t>(SetupState::STATES_COUNT)] = {
+  {10, 39, 31, 17}, // HOURS
+  {50, 39, 31, 17}, // MINUTES
+  {90, 39, 31, 17}, // SECONDS
+  {14, 9, 16, 9},   // DATE
+  {34, 9, 16, 9},   // MONTH
+  {54, 9, 32, 9}    // YEAR
+};
+
+void normalClockState();
+void setupClockState(SetupState select, bool isBlink);
+void editSetupField(bool plus, bool minus);
+void showTime(TimeStruct time, uint8_t x, uint8_t y);
+void showDateWithoutYear(DateStruct date, uint8_t x, uint8_t y);
+void showDateWithYear(DateStruct date, uint8_t x, uint8_t y);
+void showTemperature(int8_t temperature, uint8_t x, uint8_t y);
+void showCursor(SetupState select, bool isBlink);
+void showSetupField(SetupState select, bool isBlink);
+void buttonPressed(ButtonId button);
+uint8_t getIndexOfChar(char c);
+void drawChar8x8(uint8_t x, uint8_t y, char c);
+void drawDigit16x16(uint8_t x, uint8_t y, uint8_t digit);
+void drawDigit8x8(uint8_t x, uint8_t y, uint8_t digit);
+
+bool isBlink = false;
+bool clearScreen = false;
+bool secondCheckPending = false;
+
+enum TaskId : uint8_t {
+    BUTTONS_TASK,
+    CLOCK_TASK,
+    BLINK_TASK,
+    RENDER_TASK,
+    TASK_COUNT
+};
+void buttonsTask();
+void clockTask();
+void blinkTask();
+void renderTask();
+// the display only changes when a task triggers the render task
+static constexpr SchedulerTask tasks[TASK_COUNT] = {
+    {buttonsTask, 0, 5},
+    {clockTask, 10, 10},
+    {blinkTask, 200, 50},
+    {renderTask, 0, 50}
+};
+
+// Power state machine: run the due tasks, then sleep with WFI, or go to standby until the next second
+// when the screen is up to date and nothing can happen before (no button held, no transfer running).
+struct PowerIdle {
+  // the AWU runs on the LSI, which is a few percent off: wake up after the square wave edge
+  // or, without it, shortly before the chip second changes
+  static constexpr uint32_t STANDBY_LATE_MS = 50;
+  static constexpr uint32_t STANDBY_EARLY_MS = 40;
+  static inline uint8_t _standbySecond = 0xFF;
+
+  static bool canStandby();
+  static void idle(uint32_t ms);
+};
+Scheduler<SysTickMsTimer, TASK_COUNT, PowerIdle> scheduler(tasks);
+
+void runClock() {
+  if(!Clocks::init()) {
+      for(;;){}
+  }
+  SysTickMsTimer::init();
+
+  I2c1SDA::init();
+  I2c1SCL::init();
+  I2c1::init();
+  
+  // static storage keeps them off the 256 byte stack, the constructors run at compile time
+  static Rtc ExtClock(0x68<<1);
+  pExtClock = &ExtClock;
+  ExtClock.init();
+  if(RTC_SECOND_TICK) {
+    ExtClock.enableSquareWave1Hz();
+    RtcSqwPin::init();
+    RtcSqwExti::setEventCallback([]() { scheduler.trigger(CLOCK_TASK); });
+    RtcSqwExti::init();
+  }
+  // the buttons task only runs after an edge and while the buttons settle or are held
+  ButtonInput::init();
+  ButtonInput::setEdgeCallback([]() { scheduler.trigger(BUTTONS_TASK); });
+  ButtonInput::setRepeat(PLUS_BUTTON, true);
+  ButtonInput::setRepeat(MINUS_BUTTON, true);
+  if(LOW_POWER_STANDBY) {
+    Power::init();
+  }
+  static RtcClock Clock(ExtClock);
+  pClock = &Clock;
+  Clock.resync();
+  
+  static Oled OledDisplay(0x3C<<1, oledBuf);
+  pOledDisplay = &OledDisplay;
+  OledDisplay.init();
+
+  OledDisplay.fill(0);
+  OledDisplay.updateScreen();
+
+  scheduler.trigger(RENDER_TASK);
+  scheduler.run();
+}
+
+void buttonsTask() {
+  uint32_t next = ButtonInput::update();
+  if(next != 0) {
+    scheduler.triggerAfter(BUTTONS_TASK, next);
+  }
+  ButtonEvent event;
+  while(ButtonInput::takeEvent(event)) {
+    // holding Plus or Minus repeats the step
+    if(event.type == ButtonEventType::press || event.type == ButtonEventType::repeat) {
+      buttonPressed(static_cast<ButtonId>(event.button));
+    }
+  }
+}
+
+void buttonPressed(ButtonId button) {
+  bool mode = button == MODE_BUTTON;
+  bool plus = button == PLUS_BUTTON;
+  bool minus = button == MINUS_BUTTON;
+  switch(clockState) {
+  case ClockState::NORMAL:
+    if(mode) {
+      // setup edits the register image, which is only read on a resync: start from the chip time
+      pClock->resync();
+      clockState = ClockState::SETUP;
+      setupState = SetupState::HOURS;
+      clearScreen = true;
+    }
+    break;
+  case ClockState::SETUP:
+    editSetupField(plus, minus);
+    if(mode) {
+      if(setupState == SetupState::YEAR) {
+        pExtClock->flush();
+        pClock->resync();
+        clockState = ClockState::NORMAL;
+        clearScreen = true;
+      } else {
+        setupState = SetupState(static_cast<uint8_t>(setupState)+1);
+        clearScreen = true;
+      }
+    }
+    break;
+  }
+  scheduler.trigger(RENDER_TASK);
+}
+
+void clockTask() {
+  // the clock is left alone in setup mode, a resync would read back the registers being edited
+  bool secondEdge = RTC_SECOND_TICK && RtcSqwExti::takeEvent();
+  if(clockState != ClockState::NORMAL) {
+    return;
+  }
+  if(secondCheckPending) {
+    secondCheckPending = false;
+    pClock->checkSecond();
+  }
+  if(secondEdge) {
+    pClock->secondEdge();
+  }
+  if(pClock->update()) {
+    scheduler.trigger(RENDER_TASK);
+  }
+}
+
+void blinkTask() {
+  if(clockState == ClockState::SETUP) {
+    isBlink = !isBlink;
+    scheduler.trigger(RENDER_TASK);
+  }
+}
+
+void renderTask() {
+  pOledDisplay->waitForUpdate();
+  // drawing and the transfer run on the fast clock, idle() drops it again once the transfer is done
+  Clocks::select(RUN_CLOCK);
+  // glyphs overwrite their whole cell, so only layout and cursor position changes need a clean frame,
+  // in between only the setup field under the cursor changes
+  bool redraw = clearScreen || !Oled::RETAINED_FRAME;
+  if(redraw) {
+    pOledDisplay->fill(0);
+    clearScreen = false;
+  }
+  switch(clockState) {
+  case ClockState::NORMAL:
+    normalClockState();
+    break;
+  case ClockState::SETUP:
+    if(redraw) {
+      setupClockState(setupState, isBlink);
+    } else {
+      showSetupField(setupState, isBlink);
+    }
+    break;
+  }
+  pOledDisplay->updateScreen();
+}
+
+bool PowerIdle::canStandby() {
+  return clockState == ClockState::NORMAL && !secondCheckPending && !I2c1::isBusy() && !pOledDisplay->isUpdating()
+      && ButtonInput::isIdle();
+}
+
+void PowerIdle::idle(uint32_t ms) {
+  if(!I2c1::isBusy() && !pOledDisplay->isUpdating()) {
+    Clocks::select(IDLE_CLOCK);
+  }
+  if(!LOW_POWER_STANDBY || !canStandby()) {
+    SysTickMsTimer::idle(ms);
+    return;
+  }
+  uint32_t untilSecond = 1000 - pClock->getMilliseconds();
+  uint32_t standbyMs;
+  if(RTC_SECOND_TICK) {
+    standbyMs = untilSecond + STANDBY_LATE_MS;
+  } else {
+    // after the new second was seen sleep until shortly before the next one, then look for it in
+    // AWU steps, every wake-up reads the chip seconds. The new second shows up between the wake-up
+    // time and one AWU step plus the wake-up time late, 5 to 24 ms in the simulator.
+    uint8_t second = pClock->getTime().seconds;
+    bool seen = second != _standbySecond;
+    _standbySecond = second;
+    if(seen && untilSecond > STANDBY_EARLY_MS + Power::AWU_STEP_MS) {
+      standbyMs = untilSecond - STANDBY_EARLY_MS;
+    } else {
+      standbyMs = Power::AWU_STEP_MS;
+    }
+  }
+  // the periodic tasks have nothing to poll until the wake-up, it starts them anew
+  Power::standby(standbyMs);
+  // the standby time is only an estimate, the square wave edge or the chip seconds correct the local time
+  secondCheckPending = !RTC_SECOND_TICK;
+  scheduler.restart();
+  scheduler.trigger(CLOCK_TASK);
+}
+
+void normalClockState() {
+  showTime(pClock->getTime(), 10, 40);
+  showDateWithoutYear(pClock->getDate(), 14, 10);
+  showTemperature(pClock->getTemperature(), 97, 10);
+}
+
+void setupClockState(SetupState select, bool isBlink) {
+  showTime(pExtClock->getTime(), 10, 40);
+  showDateWithYear(pExtClock->getDate(), 14, 10);
+  showCursor(select, isBlink);
+}
+
+void editSetupField(bool plus, bool minus) {
+  TimeStruct time = pExtClock->getTime();
+  DateStruct date = pExtClock->getDate();
+  if(plus) {
+    switch(setupState) {
+    case SetupState::HOURS:
+      time.hours = (time.hours+1)%24;
+      break;
+    case SetupState::MINUTES:
+      time.minutes = (time.minutes+1)%60;
+      break;
+    case SetupState::SECONDS:
+      time.seconds = (time.seconds+1)%60;
+      break;
+    case SetupState::DATE:
+      date.date = 1+(date.date%31);
+      break;
+    case SetupState::MONTH:
+      date.month = 1+(date.month%12);
+      break;
+    case SetupState::YEAR:
+      date.year = (date.year+1)%100;
+      break;
+    case SetupState::STATES_COUNT:
+      break;
+    }
+    pExtClock->setDate(date);
+    pExtClock->setTime(time);
+  }
+  if(minus) {
+    switch(setupState) {
+    case SetupState::HOURS:
+      time.hours = (time.hours+23)%24;
+      break;
+    case SetupState::MINUTES:
+      time.minutes = (time.minutes+59)%60;
+      break;
+    case SetupState::SECONDS:
+      time.seconds = (time.seconds+59)%60;
+      break;
+    case SetupState::DATE:
+      date.date = 1+((date.date+29)%31);
+      break;
+    case SetupState::MONTH:
+      date.month = 1+((date.month+10)%12);
+      break;
+    case SetupState::YEAR:
+      date.year = (date.year-1)%100;
+      break;
+    case SetupState::STATES_COUNT:
+      break;
+    }
+    pExtClock->setDate(date);
+    pExtClock->setTime(time);
+  }
+}
+
+void showTime(TimeStruct time, uint8_t x, uint8_t y) {
+  drawDigit16x16(x,    y, time.hours/10);
+  drawDigit16x16(x+16, y, time.hours%10);
+
+  pOledDisplay->drawGlyph(x+32, y, colon16x16);
+  
+  drawDigit16x16(x+40, y, time.minutes/10);
+  drawDigit16x16(x+56, y, time.minutes%10);
+
+  pOledDisplay->drawGlyph(x+72, y, colon16x16);
+  
+  drawDigit16x16(x+80, y, time.seconds/10);
+  drawDigit16x16(x+96, y, time.seconds%10);
+}
+
+void showDateWithoutYear(DateStruct date, uint8_t x, uint8_t y) {
+  drawDigit8x8(x, y, date.date/10);
+  drawDigit8x8(x+8, y, date.date%10);
+
+  pOledDisplay->drawGlyph(x+16, y, dot8x8);
+
+  drawDigit8x8(x+20, y, date.month/10);
+  drawDigit8x8(x+28, y, date.month%10);
+}
+
+void showDateWithYear(DateStruct date, uint8_t x, uint8_t y) {
+  showDateWithoutYear(date, x, y);
+  uint8_t year = date.year;
+  
+  pOledDisplay->drawGlyph(x+36, y, dot8x8);
+  
+  drawChar8x8(x+40, y, '2');
+  drawChar8x8(x+48, y, '0');
+  drawDigit8x8(x+56, y, year/10);
+  drawDigit8x8(x+64, y, year%10);
+}
+
+void showTemperature(int8_t temperature, uint8_t x, uint8_t y) {
+  drawDigit8x8(x+0, y, temperature/10);
+  drawDigit8x8(x+8, y, temperature%10);
+
+  drawChar8x8(x+16, y, 'D');
+}
+
+void showCursor(SetupState select, bool isBlink) {
+  const SetupField& field = setupFields[static_cast<uint8_t>(select)];
+  if(isBlink) {
+    pOledDisplay->invertRect(field.x, field.y, field.width, field.height);
+  }
+}
+
+// Redraws only the field under the cursor, the rest of the setup screen stays in the frame buffer
+void showSetupField(SetupState select, bool isBlink) {
+  const SetupField& field = setupFields[static_cast<uint8_t>(select)];
+  uint8_t x = field.x;
+  uint8_t y = field.y + 1;
+  TimeStruct time = pExtClock->getTime();
+  DateStruct date = pExtClock->getDate();
+  pOledDisplay->clearRect(field.x, field.y, field.width, field.height);
+  switch(select) {
+  case SetupState::HOURS:
+    drawDigit16x16(x,    y, time.hours/10);
+    drawDigit16x16(x+16, y, time.hours%10);
+    break;
+  case SetupState::MINUTES:
+    drawDigit16x16(x,    y, time.minutes/10);
+    drawDigit16x16(x+16, y, time.minutes%10);
+    break;
+  case SetupState::SECONDS:
+    drawDigit16x16(x,    y, time.seconds/10);
+    drawDigit16x16(x+16, y, time.seconds%10);
+    break;
+  case SetupState::DATE:
+    drawDigit8x8(x,   y, date.date/10);
+    drawDigit8x8(x+8, y, date.date%10);
+    break;
+  case SetupState::MONTH:
+    drawDigit8x8(x,   y, date.month/10);
+    drawDigit8x8(x+8, y, date.month%10);
+    break;
+  case SetupState::YEAR:
+    drawChar8x8(x,     y, '2');
+    drawChar8x8(x+8,   y, '0');
+    drawDigit8x8(x+16, y, date.year/10);
+    drawDigit8x8(x+24, y, date.year%10);
+    break;
+  case SetupState::STATES_COUNT:
+    break;
+  }
+  showCursor(select, isBlink);
+}
+
+uint8_t getIndexOfChar(char c) {
+  return charMap[c];
+}
+
+void drawChar8x8(uint8_t x, uint8_t y, char c) {
+  pOledDisplay->drawGlyph(x, y, fontColumns8x8[getIndexOfChar(c)]);
+}
+// digits are the first glyphs of the font, no lookup needed
+void drawDigit16x16(uint8_t x, uint8_t y, uint8_t digit) {
+  pOledDisplay->drawGlyph(x, y, font16x16[digit < 10 ? digit : UNKNOWN_GLYPH]);
+}
+void drawDigit8x8(uint8_t x, uint8_t y, uint8_t digit) {
+  pOledDisplay->drawGlyph(x, y, fontColumns8x8[digit < 10 ? digit : UNKNOWN_GLYPH]);
+}
\ No newline at end of file